@@ -0,0 +1,34 @@
+#version 410
+layout (location = 0) in vec2 worldPosition;
+
+uniform float gridSize;
+uniform float lineWidth;
+uniform float worldSize;
+
+const vec3 CellColor = vec3(0.7);
+const vec3 LineColor = vec3(0.35);
+const vec3 OutsideColor = vec3(0.15);
+const vec3 BorderColor = vec3(0.8, 0.2, 0.2);
+
+out vec4 FragColor;
+
+void main() {
+    vec2 footprint = fwidth(worldPosition);
+    float pixel = max(footprint.x, footprint.y);
+
+    // Distance to the nearest grid line on each axis, faded out once lines get thinner than a pixel.
+    vec2 distance = abs(fract(worldPosition / gridSize + 0.5) - 0.5) * gridSize;
+    float halfWidth = lineWidth * 0.5;
+
+    vec2 lines = (1.0 - smoothstep(halfWidth - footprint, halfWidth + footprint, distance)) * min(vec2(halfWidth) / footprint, 1.0);
+    vec3 color = mix(CellColor, LineColor, max(lines.x, lines.y));
+
+    // Everything outside of the world is dimmed, with a border line on the edge.
+    vec2 outside = abs(worldPosition) - worldSize;
+    float edge = max(outside.x, outside.y);
+
+    color = mix(color, OutsideColor, smoothstep(-pixel, pixel, edge));
+    color = mix(color, BorderColor, 1.0 - smoothstep(lineWidth - pixel, lineWidth + pixel, abs(edge)));
+
+    FragColor = vec4(color, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 410
+layout (location = 0) in vec2 aPos;
+layout (location = 0) out vec2 worldPosition;
+
+uniform float zoom;
+uniform float aspect;
+uniform vec2 cameraPosition;
+
+void main() {
+    gl_Position = vec4(aPos, 0, 1);
+    worldPosition = vec2(aPos.x * aspect, aPos.y) / zoom + cameraPosition;
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 410
+layout (location = 0) in vec4 color;
+layout (location = 1) in vec2 texcoord;
+
+uniform sampler2D density;
+uniform vec2 marker; // Camera position in grid space
+
+out vec4 FragColor;
+
+const vec4 Background = vec4(0.0, 0.0, 0.0, 0.4);
+const vec3 Sparse = vec3(0.2, 0.6, 1.0);
+const vec3 Dense = vec3(1.0, 0.35, 0.2);
+
+void main() {
+    // Log scale mass, a lone small cell is already visible.
+    float value = texture(density, texcoord).r;
+
+    vec4 result = mix(Background, vec4(mix(Sparse, Dense, value), 1.0), min(value * 4.0, 1.0) * 0.8);
+
+    // Own position as a dot of a few pixels, whatever the minimap size.
+    vec2 pixels = (texcoord - marker) / fwidth(texcoord);
+    float dot = 1.0 - smoothstep(2.5, 3.5, length(pixels));
+
+    result = mix(result, vec4(1.0), dot);
+    FragColor = vec4(result.rgb, result.a * color.a);
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 410
+layout (location = 0) in vec4 color;
+layout (location = 1) in vec2 texcoord;
+layout (location = 2) flat in float glyph;
+
+uniform sampler2D glyphs;
+
+out vec4 FragColor;
+
+void main() {
+    if (glyph > 0.5) {
+        float distance = texture(glyphs, texcoord).r;
+        float edge = fwidth(distance) * 0.75;
+
+        FragColor = vec4(color.rgb, color.a * smoothstep(0.5 - edge, 0.5 + edge, distance));
+        return;
+    }
+
+    FragColor = color;
+}
\ No newline at end of file
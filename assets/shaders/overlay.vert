@@ -0,0 +1,23 @@
+#version 410
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aRect;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aRegion;
+
+layout (location = 0) out vec4 color;
+layout (location = 1) out vec2 texcoord;
+layout (location = 2) flat out float glyph;
+
+uniform vec2 screenSize;
+
+void main() {
+    // Rects are in pixels with the origin in the top left corner.
+    vec2 position = (aRect.xy + aPos * aRect.zw) / screenSize;
+
+    gl_Position = vec4(position.x * 2.0 - 1.0, 1.0 - position.y * 2.0, 0, 1);
+    color = aColor;
+
+    // Rects without an atlas region are solid.
+    texcoord = mix(aRegion.xy, aRegion.zw, aPos);
+    glyph = aRegion.z > aRegion.x ? 1.0 : 0.0;
+}
\ No newline at end of file
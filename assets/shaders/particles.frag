@@ -0,0 +1,12 @@
+#version 410
+layout (location = 0) in vec4 color;
+
+out vec4 FragColor;
+
+void main() {
+    // Soft round sprite.
+    float distance = length(gl_PointCoord * 2.0 - 1.0);
+    if (distance > 1.0) discard;
+
+    FragColor = vec4(color.rgb, color.a * (1.0 - smoothstep(0.5, 1.0, distance)));
+}
\ No newline at end of file
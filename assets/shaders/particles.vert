@@ -0,0 +1,21 @@
+#version 410
+layout (location = 0) in vec2 aPosition;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aState;
+
+layout (location = 0) out vec4 color;
+
+uniform float zoom;
+uniform float aspect;
+uniform vec2 cameraPosition;
+uniform float viewportHeight;
+
+void main() {
+    gl_Position = vec4(((aPosition.x - cameraPosition.x) / aspect) * zoom, (aPosition.y - cameraPosition.y) * zoom, 0, 1);
+
+    // World units to pixels, one unit of y spans zoom / 2 of the viewport.
+    gl_PointSize = max(aState.z * zoom * viewportHeight * 0.5, 1.0);
+
+    // Fades out over the lifetime.
+    color = vec4(aColor.rgb, aColor.a * (1.0 - aState.x / aState.y));
+}
\ No newline at end of file
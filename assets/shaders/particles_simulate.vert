@@ -0,0 +1,18 @@
+#version 410
+layout (location = 0) in vec2 aPosition;
+layout (location = 1) in vec2 aVelocity;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aState;
+
+layout (location = 0) out vec2 position;
+layout (location = 1) out vec2 velocity;
+layout (location = 2) out vec4 color;
+layout (location = 3) out vec4 state;
+
+void main() {
+    // Particles and emitters are told apart in the geometry shader, which decides what gets captured.
+    position = aPosition;
+    velocity = aVelocity;
+    color = aColor;
+    state = aState;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 410
+layout (location = 0) in vec2 texcoord;
+
+uniform sampler2D scene;
+uniform vec2 regionScale;
+uniform vec2 texelSize;
+uniform float sharpness;
+
+out vec4 FragColor;
+
+// Texels past the drawn region hold stale frames, keep filtering from reaching into them.
+vec3 sampleScene(vec2 coordinate) {
+    return texture(scene, min(coordinate, regionScale - texelSize * 0.5)).rgb;
+}
+
+void main() {
+    vec3 center = sampleScene(texcoord);
+
+    // Bilinear upscaling blurs edges, a small unsharp mask brings back some of the detail. Off at native scale.
+    vec3 neighbours = sampleScene(texcoord + vec2(texelSize.x, 0)) + sampleScene(texcoord - vec2(texelSize.x, 0))
+                    + sampleScene(texcoord + vec2(0, texelSize.y)) + sampleScene(texcoord - vec2(0, texelSize.y));
+
+    vec3 color = center + (center - neighbours * 0.25) * sharpness;
+    FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
\ No newline at end of file
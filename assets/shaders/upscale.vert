@@ -0,0 +1,11 @@
+#version 410
+layout (location = 0) in vec2 aPos;
+layout (location = 0) out vec2 texcoord;
+
+// Corner of the drawn region, the target is usually bigger than what was rendered into it.
+uniform vec2 regionScale;
+
+void main() {
+    gl_Position = vec4(aPos, 0, 1);
+    texcoord = (aPos * 0.5 + 0.5) * regionScale;
+}
\ No newline at end of file
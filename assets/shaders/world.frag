@@ -1,11 +1,40 @@
 #version 410
-layout (location = 0) in vec2 texcoord; 
-uniform sampler2D BallTexture;
+layout (location = 0) in vec2 texcoord;
+layout (location = 1) in vec4 hue;
+layout (location = 2) flat in float layer;
 
-uniform vec4 hue;
+uniform sampler2DArray skins;
+uniform sampler2D glyphs;
+uniform float borderWidth;
+uniform float outlineWidth;
 
 out vec4 FragColor;
 
 void main() {
-    FragColor = texture2D(BallTexture, texcoord) * hue;
+    // Layer -2 are label glyphs, a distance field with a dark outline so text reads on any cell.
+    if (layer < -1.5) {
+        float distance = texture(glyphs, texcoord).r;
+        float edge = fwidth(distance) * 0.75;
+
+        float alpha = smoothstep(0.5 - outlineWidth - edge, 0.5 - outlineWidth + edge, distance);
+        float fill = smoothstep(0.5 - edge, 0.5 + edge, distance);
+
+        FragColor = vec4(hue.rgb * fill, hue.a * alpha);
+        return;
+    }
+
+    // Negative layers are procedural cells: an analytic circle with a darker border ring,
+    // anti-aliased over one pixel at any zoom and without a texture fetch.
+    if (layer < 0.0) {
+        float distance = length(texcoord * 2.0 - 1.0);
+        float edge = fwidth(distance);
+
+        float alpha = 1.0 - smoothstep(1.0 - edge, 1.0, distance);
+        float border = smoothstep(1.0 - borderWidth - edge, 1.0 - borderWidth, distance);
+
+        FragColor = vec4(mix(hue.rgb, hue.rgb * 0.75, border), hue.a * alpha);
+        return;
+    }
+
+    FragColor = texture(skins, vec3(texcoord, layer)) * hue;
 } 
\ No newline at end of file
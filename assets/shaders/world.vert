@@ -1,14 +1,24 @@
 #version 410
 layout (location = 0) in vec2 aPos;
-layout (location = 0) out vec2 texcoord; 
+layout (location = 1) in vec4 aCell;
+layout (location = 2) in vec4 aHue;
+layout (location = 3) in vec4 aRegion;
+layout (location = 4) in float aLayer;
+
+layout (location = 0) out vec2 texcoord;
+layout (location = 1) out vec4 hue;
+layout (location = 2) flat out float layer;
 
 uniform float zoom;
-uniform float size;
 uniform float aspect;
-uniform vec2 position;
 uniform vec2 cameraPosition;
 
 void main() {
-    gl_Position = vec4(((aPos.x  * size + position.x - cameraPosition.x) / aspect) * zoom, (aPos.y  * size + position.y - cameraPosition.y) * zoom, 0, 1);
-    texcoord = aPos.xy;
+    // Cells and glyphs share the stream: center, half extents and the texture region to stretch over the quad.
+    vec2 position = aCell.xy + (aPos * 2.0 - 1.0) * aCell.zw;
+
+    gl_Position = vec4(((position.x - cameraPosition.x) / aspect) * zoom, (position.y - cameraPosition.y) * zoom, 0, 1);
+    texcoord = mix(aRegion.xy, aRegion.zw, aPos);
+    hue = aHue;
+    layer = aLayer;
 }
\ No newline at end of file
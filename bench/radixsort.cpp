@@ -0,0 +1,58 @@
+#include "../src/engine/util/radixsort.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Compares the draw order sort against std::sort on the same keys, both producing a stable order.
+static double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void run(size_t count, int iterations) {
+    std::mt19937 random(1234);
+    // Cell masses are heavily skewed towards small food pellets, like in a real game.
+    std::exponential_distribution<float> mass(0.05f);
+
+    std::vector<uint16_t> keys(count);
+    for(uint16_t &key : keys) {
+        key = static_cast<uint16_t>(std::min(mass(random) * 512.0f, 65535.0f));
+    }
+
+    Brainstorm::RadixSorter sorter;
+    sorter.reserve(count);
+
+    std::vector<uint64_t> packed(count);
+
+    double radix = 0, standard = 0;
+    uint64_t checksum = 0;
+
+    for(int i = 0; i < iterations; i++) {
+        double start = now();
+        const std::vector<uint32_t> &order = sorter.sort(keys.data(), count);
+        radix += now() - start;
+
+        checksum += order[count / 2];
+
+        start = now();
+        for(size_t j = 0; j < count; j++) {
+            packed[j] = static_cast<uint64_t>(keys[j]) << 32 | j;
+        }
+        std::sort(packed.begin(), packed.end());
+        standard += now() - start;
+
+        checksum -= static_cast<uint32_t>(packed[count / 2]);
+    }
+
+    printf("%7zu instances: radix %.3f ms, std::sort %.3f ms (%.1fx)%s\n", count,
+           radix / iterations, standard / iterations, standard / radix, checksum == 0 ? "" : " MISMATCH");
+}
+
+int main() {
+    run(10000, 1000);
+    run(100000, 200);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "../src/engine/engine.h"
+#include "../src/renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Replays a recorded frame (F3 in the game) or a generated scene into an offscreen target, without a display,
+// and reports the CPU time spent submitting each frame and the GPU time spent rasterizing it.
+//
+//     RenderBench [scene.bin] [frames] [world resolution scale]
+
+static const int WarmupFrames = 10;
+
+static double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void generateScene(BS::FramePacket &packet, BS::Font &font, size_t count) {
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-8.0f, 8.0f), color(0.2f, 1.0f);
+    std::exponential_distribution<float> mass(0.02f);
+
+    packet.view.cameraPosition = glm::vec2(0.0f);
+    packet.view.zoom = 0.12f;
+    packet.view.aspect = static_cast<float>(packet.view.framebufferSize.x) / static_cast<float>(packet.view.framebufferSize.y);
+
+    packet.draw(PASS_GRID, 0, 0);
+
+    std::vector<float> masses(count);
+    for(float &cell : masses) {
+        cell = 1.0f + mass(random);
+    }
+    std::sort(masses.begin(), masses.end());
+
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+
+    for(float cell : masses) {
+        glm::vec2 center(position(random), position(random));
+        float radius = cell * 0.004f;
+
+        WorldRenderer::pushCell(packet, center, radius, glm::vec4(color(random), color(random), color(random), 1.0f), -1);
+
+        if(radius * packet.view.zoom >= 0.05f) {
+            WorldRenderer::pushText(packet, font, std::to_string(static_cast<int>(cell)), center, radius * 0.4f, glm::vec4(1.0f));
+        }
+    }
+
+    packet.draw(PASS_CELLS, offset, static_cast<uint32_t>((packet.instances.size() - offset) / WorldRenderer::CellFloats));
+    WorldRenderer::pushLeaderboard(packet, font, {"1. Bench 1000", "2. Bench 500", "3. Bench 250"});
+}
+
+static void report(const char *name, std::vector<float> samples) {
+    if(samples.empty()) {
+        printf("%-10s no samples\n", name);
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for(float sample : samples) {
+        sum += sample;
+    }
+
+    printf("%-10s avg %7.3f ms  p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms\n", name, sum / samples.size(),
+           samples[samples.size() / 2], samples[std::min(samples.size() - 1, samples.size() * 99 / 100)], samples.back());
+}
+
+int main(int argc, char **argv) {
+    const char *scene = argc > 1 ? argv[1] : nullptr;
+    int frames = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 500;
+    float scale = argc > 3 ? std::clamp(static_cast<float>(std::atof(argv[3])), 0.1f, 1.0f) : 1.0f;
+
+    BS::Window::create(1920, 1080, "RenderBench", true);
+
+    {
+        WorldRenderer renderer;
+        BS::FramePacket packet;
+
+        if(scene == nullptr || !packet.load(scene)) {
+            packet.view.framebufferSize = glm::ivec2(1920, 1080);
+            generateScene(packet, renderer.getFont(), 20000);
+        }
+
+        glm::ivec2 size = packet.view.framebufferSize;
+        BS::FrameBuffer target({BS::Attachment(BS::AttachmentType::COLOR_RGBA, BS::Texture::FILTER_LINEAR, BS::Texture::CLAMP_TO_EDGE)}, size.x, size.y);
+        // Pinned, an adaptive scale would make runs incomparable.
+        renderer.setOutput(target.getId());
+        renderer.setResolutionScale(scale, scale);
+
+        printf("%d frames at %dx%d, world at %d%%, %zu commands, %zu instance floats\n", frames, size.x, size.y,
+               static_cast<int>(scale * 100.0f + 0.5f), packet.commands.size(), packet.instances.size());
+
+        BS::GpuTimer timer;
+        std::vector<float> submit, rasterize;
+
+        for(int i = 0; i < WarmupFrames + frames; i++) {
+            double start = now();
+
+            timer.begin();
+            renderer.render(packet);
+            timer.end();
+
+            float submitTime = static_cast<float>(now() - start);
+
+            // One frame in flight at a time, so every query has its result once the GPU is idle.
+            glFinish();
+
+            if(timer.poll() && i >= WarmupFrames) {
+                submit.push_back(submitTime);
+                rasterize.push_back(timer.getMilliseconds());
+            }
+        }
+
+        report("submit", submit);
+        report("rasterize", rasterize);
+
+        timer.destroy();
+        renderer.destroy();
+    }
+
+    BS::Window::close();
+
+    return 0;
+}
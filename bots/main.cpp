@@ -0,0 +1,186 @@
+#include "../src/clientcore.h"
+#include "../src/engine/util/time.h"
+
+#include <enet/enet.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load test: many headless clients in one process, each wandering on its own. They run the same ClientCore as
+// the game, unthreaded, so a few worker threads drive all of them.
+//
+//     Bots -n 30 --port 25565
+
+// Heads somewhere at random and picks a new heading every few seconds.
+class WanderInput : public InputSource {
+private:
+    std::mt19937 generator;
+    glm::vec2 pointer;
+    int framesLeft;
+public:
+    WanderInput(uint32_t seed) : generator(seed), pointer(0.0f), framesLeft(0) {}
+
+    glm::vec2 getPointer() override {
+        if(framesLeft-- <= 0) {
+            std::uniform_real_distribution<float> angle(0.0f, 6.2831853f), distance(0.2f, 1.0f);
+            float heading = angle(generator);
+
+            pointer = glm::vec2(glm::cos(heading), glm::sin(heading)) * distance(generator);
+            framesLeft = std::uniform_int_distribution<int>(30, 300)(generator);
+        }
+
+        return pointer;
+    }
+};
+
+struct Bot {
+    std::unique_ptr<ClientCore> core;
+    WanderInput input;
+};
+
+int main(int argc, char **argv) {
+    int count = 10;
+    std::string host = "localhost";
+    int port = 25566;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    float frameRate = 30.0f;
+    double duration = 0.0;
+    uint32_t seed = 1;
+
+    std::vector<std::string> args;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg.find('=') == std::string::npos) {
+            args.push_back(arg);
+        } else {
+            args.push_back(arg.substr(0, arg.find('=')));
+            args.push_back(arg.substr(arg.find('=') + 1));
+        }
+    }
+
+    try {
+        for(size_t i = 0; i < args.size(); ++i) {
+            if(args[i] == "-h" || args[i] == "--help") {
+                printf(
+                    "Usage:\n    Bots [arguments]\n\nArguments:\n"
+                    "    -n or --count                Number of bots\n"
+                    "    --host                       Host of the server\n"
+                    "    -p or --port                 Port of the server\n"
+                    "    -t or --threads              Worker threads the bots are spread over\n"
+                    "    -r or --rate                 Frames per second of every bot\n"
+                    "    -d or --duration             Seconds to run, 0 runs until killed\n"
+                    "    --seed                       Seed of the bot movement\n"
+                    "    -h or --help                 Print Help (This message) and exit\n");
+                return 0;
+            } else if(args[i] == "-n" || args[i] == "--count") {
+                count = std::stoi(args.at(++i));
+            } else if(args[i] == "--host") {
+                host = args.at(++i);
+            } else if(args[i] == "-p" || args[i] == "--port") {
+                port = std::stoi(args.at(++i));
+            } else if(args[i] == "-t" || args[i] == "--threads") {
+                threads = std::max(1, std::stoi(args.at(++i)));
+            } else if(args[i] == "-r" || args[i] == "--rate") {
+                frameRate = std::stof(args.at(++i));
+            } else if(args[i] == "-d" || args[i] == "--duration") {
+                duration = std::stod(args.at(++i));
+            } else if(args[i] == "--seed") {
+                seed = static_cast<uint32_t>(std::stoul(args.at(++i)));
+            }
+        }
+    } catch(...) {
+        throw std::invalid_argument("Invalid arguments");
+    }
+
+    if(enet_initialize() != 0) {
+        printf("Error: can't initialize enet\n");
+        return 1;
+    }
+
+    // Big enough to live on the heap, every core holds a few snapshot rings.
+    std::vector<Bot> bots;
+    bots.reserve(count);
+
+    PlayerState spawn;
+    spawn.count = 1;
+    spawn.cells[0] = {glm::vec2(0.0f), 20.0f};
+
+    for(int i = 0; i < count; i++) {
+        bots.push_back({std::make_unique<ClientCore>(host, static_cast<uint16_t>(port)), WanderInput(seed + i)});
+
+        bots.back().core->spawn(spawn);
+        if(!bots.back().core->start(false)) return 1;
+    }
+
+    printf("Info: %d bots on %d threads at %.0f fps\n", count, threads, frameRate);
+
+    // Game side state belongs to the workers, they report it here for the stats.
+    std::vector<std::atomic<bool>> inGame(bots.size());
+
+    double start = Brainstorm::Timer::now();
+    double end = duration > 0.0 ? start + duration : 0.0;
+    float interval = 1.0f / frameRate;
+
+    // Each worker steps its share of the bots once per frame, then sleeps until the next one.
+    std::vector<std::thread> workers;
+    for(int worker = 0; worker < threads; worker++) {
+        workers.emplace_back([&, worker]() {
+            double nextFrame = Brainstorm::Timer::now();
+
+            while(end == 0.0 || Brainstorm::Timer::now() < end) {
+                double now = Brainstorm::Timer::now();
+
+                for(size_t i = worker; i < bots.size(); i += threads) {
+                    bots[i].core->update(bots[i].input, interval, now);
+                    inGame[i].store(bots[i].core->isWelcomed(), std::memory_order_relaxed);
+                }
+
+                nextFrame = std::max(nextFrame + interval, now);
+                std::this_thread::sleep_for(std::chrono::duration<double>(nextFrame - Brainstorm::Timer::now()));
+            }
+        });
+    }
+
+    // Traffic counters are atomics, reading them from here while the workers run is fine.
+    const double StatsInterval = 5.0;
+
+    while(end == 0.0 || Brainstorm::Timer::now() < end) {
+        // The last report comes at the end of the run, not up to an interval after it.
+        double wait = end == 0.0 ? StatsInterval : std::min(StatsInterval, end - Brainstorm::Timer::now());
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::max(wait, 0.0)));
+
+        int welcomed = 0;
+        uint64_t sent = 0, received = 0, roundTripTime = 0;
+
+        for(size_t i = 0; i < bots.size(); i++) {
+            const NetStats &stats = bots[i].core->getStats();
+
+            welcomed += inGame[i].load(std::memory_order_relaxed) ? 1 : 0;
+            sent += stats.getTotal(TRAFFIC_SENT).bytes;
+            received += stats.getTotal(TRAFFIC_RECEIVED).bytes;
+            roundTripTime += stats.getLink().roundTripTime;
+        }
+
+        printf("bots: %d/%d in game, sent %.1fkB received %.1fkB, mean rtt %.1fms\n", welcomed, count,
+               sent / 1000.0, received / 1000.0, bots.empty() ? 0.0 : static_cast<double>(roundTripTime) / bots.size());
+    }
+
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+
+    for(Bot &bot : bots) {
+        bot.core->stop();
+    }
+
+    enet_deinitialize();
+    return 0;
+}
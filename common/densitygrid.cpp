@@ -0,0 +1,124 @@
+#include "densitygrid.h"
+
+#include <cstring>
+
+DensityGrid::DensityGrid() : dirty(0) {
+    mass.fill(0.0f);
+    cells.fill(0);
+    sent.fill(0);
+}
+
+int DensityGrid::getCell(const glm::vec2 &position) {
+    glm::ivec2 cell = glm::ivec2((position / WorldSize * 0.5f + 0.5f) * static_cast<float>(Size));
+    cell = glm::clamp(cell, glm::ivec2(0), glm::ivec2(Size - 1));
+
+    return cell.y * Size + cell.x;
+}
+
+uint8_t DensityGrid::quantize(float mass) {
+    // 20 steps per doubling, saturates around a mass of 7000.
+    float value = glm::log2(glm::max(mass, 0.0f) + 1.0f) * 20.0f;
+    return static_cast<uint8_t>(glm::min(value + 0.5f, 255.0f));
+}
+
+void DensityGrid::accumulate(int cell, float mass) {
+    // Repeated adds and removes leave float residue, never let it go negative.
+    this->mass[cell] = glm::max(this->mass[cell] + mass, 0.0f);
+
+    uint8_t value = quantize(this->mass[cell]);
+    if(value == cells[cell]) return;
+
+    cells[cell] = value;
+    dirty |= uint64_t(1) << (cell / Size);
+}
+
+void DensityGrid::add(const glm::vec2 &position, double mass) {
+    accumulate(getCell(position), static_cast<float>(mass));
+}
+
+void DensityGrid::remove(const glm::vec2 &position, double mass) {
+    accumulate(getCell(position), -static_cast<float>(mass));
+}
+
+void DensityGrid::update(const glm::vec2 &from, double fromMass, const glm::vec2 &to, double toMass) {
+    int source = getCell(from), destination = getCell(to);
+
+    if(source == destination) {
+        accumulate(source, static_cast<float>(toMass - fromMass));
+        return;
+    }
+
+    accumulate(source, -static_cast<float>(fromMass));
+    accumulate(destination, static_cast<float>(toMass));
+}
+
+bool DensityGrid::encodeDelta(std::vector<uint8_t> &out) {
+    uint64_t changed = 0;
+
+    // A row can be dirty and still match what was sent, e.g. a cell that left and came back.
+    for(int row = 0; row < Size; row++) {
+        if(!(dirty & (uint64_t(1) << row))) continue;
+
+        if(std::memcmp(&cells[row * Size], &sent[row * Size], Size) != 0) {
+            changed |= uint64_t(1) << row;
+        }
+    }
+
+    dirty = 0;
+    if(changed == 0) return false;
+
+    for(int i = 0; i < 8; i++) {
+        out.push_back(static_cast<uint8_t>(changed >> (i * 8)));
+    }
+
+    for(int row = 0; row < Size; row++) {
+        if(!(changed & (uint64_t(1) << row))) continue;
+
+        out.insert(out.end(), &cells[row * Size], &cells[row * Size] + Size);
+        std::memcpy(&sent[row * Size], &cells[row * Size], Size);
+    }
+
+    return true;
+}
+
+void DensityGrid::encodeFull(std::vector<uint8_t> &out) const {
+    for(int i = 0; i < 8; i++) {
+        out.push_back(0xFF);
+    }
+
+    out.insert(out.end(), cells.begin(), cells.end());
+}
+
+uint64_t DensityGrid::decode(const uint8_t *data, size_t size) {
+    return decode(data, size, cells.data());
+}
+
+uint64_t DensityGrid::decode(const uint8_t *data, size_t size, uint8_t *cells) {
+    if(size < 8) return 0;
+
+    uint64_t rows = 0;
+    for(int i = 0; i < 8; i++) {
+        rows |= static_cast<uint64_t>(data[i]) << (i * 8);
+    }
+
+    int count = 0;
+    for(int row = 0; row < Size; row++) {
+        count += (rows >> row) & 1;
+    }
+
+    if(size != 8 + static_cast<size_t>(count) * Size) return 0;
+
+    const uint8_t *source = data + 8;
+    for(int row = 0; row < Size; row++) {
+        if(!(rows & (uint64_t(1) << row))) continue;
+
+        std::memcpy(&cells[row * Size], source, Size);
+        source += Size;
+    }
+
+    return rows;
+}
+
+const uint8_t *DensityGrid::getRow(int row) const {
+    return &cells[row * Size];
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Coarse mass density of the whole world, shared by the server and the client minimap. The server keeps it
+// current as cells move, grow and die; clients only ever receive the quantized rows that changed.
+//
+// Encoded form: a little endian 64 bit mask of the rows that follow, then Size bytes for each of those rows in
+// ascending order. Rows carry their absolute values, so a late or repeated update never corrupts the grid.
+class DensityGrid {
+public:
+    static const int Size = 64;
+    // Half extent of the world, matches the grid pass.
+    static constexpr float WorldSize = 1000.0f;
+    // ENet channel the grid is streamed on, gameplay traffic stays on channel 0.
+    static const uint8_t Channel = 1;
+private:
+    std::array<float, Size * Size> mass;
+    std::array<uint8_t, Size * Size> cells, sent;
+
+    // Rows whose quantized value may differ from what was last encoded.
+    uint64_t dirty;
+
+    static int getCell(const glm::vec2 &position);
+    static uint8_t quantize(float mass);
+
+    void accumulate(int cell, float mass);
+public:
+    DensityGrid();
+
+    void add(const glm::vec2 &position, double mass);
+    void remove(const glm::vec2 &position, double mass);
+    // A cell that moved, grew or shrank since it was last added.
+    void update(const glm::vec2 &from, double fromMass, const glm::vec2 &to, double toMass);
+
+    // Server side. Appends the rows that changed since the last call, returns false if none did.
+    bool encodeDelta(std::vector<uint8_t> &out);
+    // Every row, for clients that just connected.
+    void encodeFull(std::vector<uint8_t> &out) const;
+
+    // Client side. Returns the mask of rows that were written, 0 for a malformed update.
+    uint64_t decode(const uint8_t *data, size_t size);
+    // Into Size rows of Size cells kept elsewhere, for clients that need nothing but the quantized cells.
+    static uint64_t decode(const uint8_t *data, size_t size, uint8_t *cells);
+
+    // Row 0 is the bottom of the world, one byte per cell on a log scale of its mass.
+    const uint8_t *getRow(int row) const;
+};
@@ -0,0 +1,31 @@
+#include "movement.h"
+#include "densitygrid.h"
+
+float getCellRadius(float points) {
+    return points * 0.004f;
+}
+
+glm::vec2 getCellVelocity(const glm::vec2 &pointer, float radius) {
+    // Full speed once the pointer is this far from the center.
+    const float PointerRadius = 0.1f;
+
+    glm::vec2 velocity = pointer / PointerRadius;
+    float length = glm::length(velocity);
+
+    if(length > 0.0f && length > 1 - glm::max(0.5f, radius)) {
+        velocity /= length;
+    }
+
+    return velocity;
+}
+
+void applyInput(PlayerState &state, const MoveInput &input) {
+    float delta = glm::clamp(input.delta, 0.0f, MaxInputDelta);
+
+    for(size_t i = 0; i < state.count; i++) {
+        CellState &cell = state.cells[i];
+
+        cell.position += getCellVelocity(input.pointer, getCellRadius(cell.points)) * delta;
+        cell.position = glm::clamp(cell.position, glm::vec2(-DensityGrid::WorldSize), glm::vec2(DensityGrid::WorldSize));
+    }
+}
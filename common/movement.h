@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Movement shared by the server, which owns it, and the client, which predicts it. Both sides have to run
+// exactly this code on the same inputs for the prediction to hold.
+
+const size_t MaxCells = 16;
+// Longest step a single input may take, a client that stalls cannot teleport.
+const float MaxInputDelta = 0.1f;
+
+struct MoveInput {
+    uint32_t sequence;
+    glm::vec2 pointer; // Mouse offset from the screen center, in half screen heights
+    float delta; // Seconds the input was held for
+};
+
+struct CellState {
+    glm::vec2 position;
+    float points;
+};
+
+struct PlayerState {
+    size_t count = 0;
+    std::array<CellState, MaxCells> cells;
+};
+
+float getCellRadius(float points);
+glm::vec2 getCellVelocity(const glm::vec2 &pointer, float radius);
+
+// Moves every cell of the player towards the pointer, clamped to the world.
+void applyInput(PlayerState &state, const MoveInput &input);
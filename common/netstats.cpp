@@ -0,0 +1,85 @@
+#include "netstats.h"
+#include "protocol.h"
+
+NetStats::NetStats() {
+    reset();
+}
+
+TrafficKind NetStats::classify(uint8_t channel, const uint8_t *data, size_t size) {
+    if(channel == CHANNEL_MINIMAP) return TRAFFIC_MINIMAP;
+
+    MessageType type;
+    if(!peekMessageType(data, size, type)) return TRAFFIC_UNKNOWN;
+
+    switch(type) {
+        case MESSAGE_WELCOME: return TRAFFIC_WELCOME;
+        case MESSAGE_INPUT: return TRAFFIC_INPUT;
+        case MESSAGE_SNAPSHOT: return TRAFFIC_SNAPSHOT;
+        default: return TRAFFIC_UNKNOWN;
+    }
+}
+
+const char *NetStats::getKindName(TrafficKind kind) {
+    static const char *names[TRAFFIC_KIND_COUNT] = {"welcome", "input", "snapshot", "minimap", "unknown"};
+    return kind < TRAFFIC_KIND_COUNT ? names[kind] : "unknown";
+}
+
+void NetStats::count(TrafficDirection direction, TrafficKind kind, size_t size) {
+    packets[direction][kind].fetch_add(1, std::memory_order_relaxed);
+    bytes[direction][kind].fetch_add(size, std::memory_order_relaxed);
+}
+
+void NetStats::count(TrafficDirection direction, uint8_t channel, const uint8_t *data, size_t size) {
+    count(direction, classify(channel, data, size), size);
+}
+
+TrafficStats NetStats::getTraffic(TrafficDirection direction, TrafficKind kind) const {
+    TrafficStats stats;
+    stats.packets = packets[direction][kind].load(std::memory_order_relaxed);
+    stats.bytes = bytes[direction][kind].load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+TrafficStats NetStats::getTotal(TrafficDirection direction) const {
+    TrafficStats total;
+
+    for(int kind = 0; kind < TRAFFIC_KIND_COUNT; kind++) {
+        TrafficStats stats = getTraffic(direction, static_cast<TrafficKind>(kind));
+        total.packets += stats.packets;
+        total.bytes += stats.bytes;
+    }
+
+    return total;
+}
+
+void NetStats::sampleLink(const ENetPeer *peer) {
+    roundTripTime.store(peer->roundTripTime, std::memory_order_relaxed);
+    roundTripTimeVariance.store(peer->roundTripTimeVariance, std::memory_order_relaxed);
+    packetLoss.store(peer->packetLoss, std::memory_order_relaxed);
+    throttle.store(peer->packetThrottle, std::memory_order_relaxed);
+}
+
+LinkStats NetStats::getLink() const {
+    LinkStats link;
+    link.roundTripTime = roundTripTime.load(std::memory_order_relaxed);
+    link.roundTripTimeVariance = roundTripTimeVariance.load(std::memory_order_relaxed);
+    link.packetLoss = static_cast<float>(packetLoss.load(std::memory_order_relaxed)) / ENET_PEER_PACKET_LOSS_SCALE;
+    link.throttle = static_cast<float>(throttle.load(std::memory_order_relaxed)) / ENET_PEER_PACKET_THROTTLE_SCALE;
+
+    return link;
+}
+
+void NetStats::reset() {
+    for(int direction = 0; direction < 2; direction++) {
+        for(int kind = 0; kind < TRAFFIC_KIND_COUNT; kind++) {
+            packets[direction][kind].store(0, std::memory_order_relaxed);
+            bytes[direction][kind].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    roundTripTime.store(0, std::memory_order_relaxed);
+    roundTripTimeVariance.store(0, std::memory_order_relaxed);
+    packetLoss.store(0, std::memory_order_relaxed);
+    throttle.store(ENET_PEER_PACKET_THROTTLE_SCALE, std::memory_order_relaxed);
+}
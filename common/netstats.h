@@ -0,0 +1,65 @@
+#pragma once
+#include <enet/enet.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Traffic counters of one connection, or of all of them. Counting is a couple of relaxed atomic adds per packet,
+// so the networking thread never waits and any other thread can read the numbers at any time. Each counter is
+// exact on its own, a set of them read together may be a packet apart.
+
+// What a packet carries: its MessageType, or the channel for messages without a type byte.
+enum TrafficKind : uint8_t {
+    TRAFFIC_WELCOME,
+    TRAFFIC_INPUT,
+    TRAFFIC_SNAPSHOT,
+    TRAFFIC_MINIMAP,
+    TRAFFIC_UNKNOWN,
+    TRAFFIC_KIND_COUNT
+};
+
+enum TrafficDirection : uint8_t {
+    TRAFFIC_SENT,
+    TRAFFIC_RECEIVED
+};
+
+struct TrafficStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+};
+
+// Link quality as ENet measures it for a peer.
+struct LinkStats {
+    uint32_t roundTripTime = 0; // Milliseconds
+    uint32_t roundTripTimeVariance = 0; // Milliseconds
+    float packetLoss = 0.0f; // Fraction of reliable packets that needed a resend
+    float throttle = 1.0f; // Fraction of unreliable packets ENet lets through
+};
+
+class NetStats {
+private:
+    std::array<std::array<std::atomic<uint64_t>, TRAFFIC_KIND_COUNT>, 2> packets, bytes;
+
+    // In ENet units, converted on read.
+    std::atomic<uint32_t> roundTripTime, roundTripTimeVariance, packetLoss, throttle;
+public:
+    NetStats();
+
+    static TrafficKind classify(uint8_t channel, const uint8_t *data, size_t size);
+    static const char *getKindName(TrafficKind kind);
+
+    void count(TrafficDirection direction, TrafficKind kind, size_t size);
+    void count(TrafficDirection direction, uint8_t channel, const uint8_t *data, size_t size);
+
+    TrafficStats getTraffic(TrafficDirection direction, TrafficKind kind) const;
+    TrafficStats getTotal(TrafficDirection direction) const;
+
+    // Copies what ENet currently knows about the peer, from the thread that services it.
+    void sampleLink(const ENetPeer *peer);
+    LinkStats getLink() const;
+
+    // For a slot taken over by a new connection.
+    void reset();
+};
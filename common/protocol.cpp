@@ -0,0 +1,188 @@
+#include "protocol.h"
+
+#include <cmath>
+#include <cstring>
+
+MessageWriter::MessageWriter(std::vector<uint8_t> &out) : out(out) {}
+
+void MessageWriter::writeU8(uint8_t value) {
+    out.push_back(value);
+}
+
+void MessageWriter::writeU16(uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void MessageWriter::writeU32(uint32_t value) {
+    for(int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void MessageWriter::writeF32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    writeU32(bits);
+}
+
+MessageReader::MessageReader(const uint8_t *data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+bool MessageReader::require(size_t bytes) {
+    if(failed || size - offset < bytes) {
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+uint8_t MessageReader::readU8() {
+    if(!require(1)) return 0;
+    return data[offset++];
+}
+
+uint16_t MessageReader::readU16() {
+    if(!require(2)) return 0;
+
+    uint16_t value = static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+    offset += 2;
+
+    return value;
+}
+
+uint32_t MessageReader::readU32() {
+    if(!require(4)) return 0;
+
+    uint32_t value = 0;
+    for(int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(data[offset + i]) << (i * 8);
+    }
+    offset += 4;
+
+    return value;
+}
+
+float MessageReader::readF32() {
+    uint32_t bits = readU32();
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+size_t MessageReader::getRemaining() const {
+    return size - offset;
+}
+
+bool MessageReader::isValid() const {
+    return !failed;
+}
+
+bool peekMessageType(const uint8_t *data, size_t size, MessageType &type) {
+    if(size == 0) return false;
+
+    type = static_cast<MessageType>(data[0]);
+    return true;
+}
+
+void writeWelcome(std::vector<uint8_t> &out, const WelcomeMessage &message) {
+    MessageWriter writer(out);
+
+    writer.writeU8(MESSAGE_WELCOME);
+    writer.writeU8(message.id);
+    writer.writeU16(message.tickRate);
+}
+
+bool readWelcome(const uint8_t *data, size_t size, WelcomeMessage &message) {
+    MessageReader reader(data, size);
+    if(reader.readU8() != MESSAGE_WELCOME) return false;
+
+    message.id = reader.readU8();
+    message.tickRate = reader.readU16();
+
+    return reader.isValid() && message.tickRate > 0;
+}
+
+void writeInputs(std::vector<uint8_t> &out, const InputMessage *inputs, size_t count) {
+    MessageWriter writer(out);
+
+    writer.writeU8(MESSAGE_INPUT);
+    writer.writeU8(static_cast<uint8_t>(count));
+
+    for(size_t i = 0; i < count; i++) {
+        writer.writeU32(inputs[i].input.sequence);
+        writer.writeF32(inputs[i].input.pointer.x);
+        writer.writeF32(inputs[i].input.pointer.y);
+        writer.writeF32(inputs[i].input.delta);
+        writer.writeF32(inputs[i].points);
+    }
+}
+
+bool readInputs(const uint8_t *data, size_t size, InputMessage *inputs, size_t capacity, size_t &count) {
+    MessageReader reader(data, size);
+    if(reader.readU8() != MESSAGE_INPUT) return false;
+
+    count = reader.readU8();
+    if(count > capacity) return false;
+
+    for(size_t i = 0; i < count; i++) {
+        InputMessage &message = inputs[i];
+
+        message.input.sequence = reader.readU32();
+        message.input.pointer.x = reader.readF32();
+        message.input.pointer.y = reader.readF32();
+        message.input.delta = reader.readF32();
+        message.points = reader.readF32();
+
+        // NaN or infinite values would poison the simulation.
+        if(!std::isfinite(message.input.pointer.x) || !std::isfinite(message.input.pointer.y)
+            || !std::isfinite(message.input.delta) || !std::isfinite(message.points)) return false;
+    }
+
+    return reader.isValid();
+}
+
+void writeSnapshot(std::vector<uint8_t> &out, uint32_t tick, const EntityState *entities, size_t count) {
+    MessageWriter writer(out);
+
+    writer.writeU8(MESSAGE_SNAPSHOT);
+    writer.writeU32(tick);
+    writer.writeU16(static_cast<uint16_t>(count));
+
+    for(size_t i = 0; i < count; i++) {
+        writer.writeU8(entities[i].id);
+        writer.writeF32(entities[i].position.x);
+        writer.writeF32(entities[i].position.y);
+        writer.writeF32(entities[i].points);
+        writer.writeU32(entities[i].acknowledged);
+    }
+}
+
+bool readSnapshot(const uint8_t *data, size_t size, uint32_t &tick, EntityState *entities, size_t capacity, size_t &count) {
+    const size_t EntityBytes = 17;
+
+    MessageReader reader(data, size);
+    if(reader.readU8() != MESSAGE_SNAPSHOT) return false;
+
+    tick = reader.readU32();
+    size_t total = reader.readU16();
+
+    if(!reader.isValid() || reader.getRemaining() != total * EntityBytes) return false;
+
+    count = 0;
+    for(size_t i = 0; i < total; i++) {
+        EntityState entity;
+        entity.id = reader.readU8();
+        entity.position.x = reader.readF32();
+        entity.position.y = reader.readF32();
+        entity.points = reader.readF32();
+        entity.acknowledged = reader.readU32();
+
+        if(count < capacity) entities[count++] = entity;
+    }
+
+    return reader.isValid();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "densitygrid.h"
+#include "movement.h"
+
+// Binary messages between the client and the server, one per ENet packet. Every message starts with its
+// MessageType byte, values are little endian and floats are IEEE 754 singles.
+
+enum MessageType : uint8_t {
+    MESSAGE_WELCOME,
+    MESSAGE_INPUT,
+    MESSAGE_SNAPSHOT
+};
+
+enum Channel : uint8_t {
+    CHANNEL_CONTROL = 0, // Reliable
+    CHANNEL_MINIMAP = DensityGrid::Channel, // Reliable, DensityGrid updates without a type byte
+    CHANNEL_SNAPSHOTS = 2, // Unreliable sequenced, a late snapshot is worthless
+    CHANNEL_COUNT
+};
+
+// Server to client once connected.
+struct WelcomeMessage {
+    uint8_t id;
+    uint16_t tickRate; // Snapshots per second
+};
+
+// Client to server, one per frame. The server moves the player, the client only predicts it.
+// Sent in batches of consecutive inputs, at most MaxInputBatch per packet.
+const size_t MaxInputBatch = 32;
+
+struct InputMessage {
+    MoveInput input;
+    float points; // Reported by the client until eating moves to the server
+};
+
+struct EntityState {
+    uint8_t id;
+    glm::vec2 position;
+    float points;
+    uint32_t acknowledged; // Last input of this player the position includes
+};
+
+class MessageWriter {
+private:
+    std::vector<uint8_t> &out;
+public:
+    MessageWriter(std::vector<uint8_t> &out);
+
+    void writeU8(uint8_t value);
+    void writeU16(uint16_t value);
+    void writeU32(uint32_t value);
+    void writeF32(float value);
+};
+
+// Reads past the end return 0 and mark the message as malformed.
+class MessageReader {
+private:
+    const uint8_t *data;
+    size_t size, offset;
+    bool failed;
+
+    bool require(size_t bytes);
+public:
+    MessageReader(const uint8_t *data, size_t size);
+
+    uint8_t readU8();
+    uint16_t readU16();
+    uint32_t readU32();
+    float readF32();
+
+    size_t getRemaining() const;
+    bool isValid() const;
+};
+
+// MESSAGE_* of a packet, false for an empty one.
+bool peekMessageType(const uint8_t *data, size_t size, MessageType &type);
+
+void writeWelcome(std::vector<uint8_t> &out, const WelcomeMessage &message);
+bool readWelcome(const uint8_t *data, size_t size, WelcomeMessage &message);
+
+void writeInputs(std::vector<uint8_t> &out, const InputMessage *inputs, size_t count);
+// Decodes into caller storage, a batch larger than the capacity is malformed.
+bool readInputs(const uint8_t *data, size_t size, InputMessage *inputs, size_t capacity, size_t &count);
+
+void writeSnapshot(std::vector<uint8_t> &out, uint32_t tick, const EntityState *entities, size_t count);
+// Decodes into caller storage, entities past the capacity are skipped.
+bool readSnapshot(const uint8_t *data, size_t size, uint32_t &tick, EntityState *entities, size_t capacity, size_t &count);
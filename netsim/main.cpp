@@ -0,0 +1,362 @@
+#include <enet/enet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Loopback UDP proxy between clients and the server that makes the link worse on purpose: latency, jitter,
+// loss, duplication, reordering and a bandwidth cap, applied to each direction. Every random decision comes
+// from one seeded generator, so a seed replays the same conditions for the same traffic.
+//
+//     Server -p 25566
+//     NetSim -p 25565 --server_port 25566 --latency 50 --jitter 10 --loss 2
+//     Agar --port 25565
+
+struct Conditions {
+    double latency = 0.0; // One way, seconds
+    double jitter = 0.0; // Up to this much earlier or later, seconds
+    double loss = 0.0; // Chances from 0 to 1
+    double duplicate = 0.0;
+    double reorder = 0.0;
+    double bandwidth = 0.0; // Bytes per second, 0 for no cap
+};
+
+// Extra time a reordered datagram is held back, the ones after it overtake it.
+const double ReorderHold = 0.02;
+// Backlog behind the bandwidth cap beyond which datagrams are dropped, like a router buffer.
+const double MaxBacklogBytes = 64.0 * 1024.0;
+// Sessions without traffic for this long are closed.
+const double SessionTimeout = 30.0;
+const double StatsInterval = 5.0;
+const size_t MaxDatagram = 4096;
+
+// One direction of the simulated link.
+struct Link {
+    const char *name;
+    Conditions conditions;
+
+    double lastRelease = 0.0; // Datagrams that are not reordered leave in order
+    double busyUntil = 0.0; // When the capped link finished sending everything queued so far
+
+    uint64_t received = 0, forwarded = 0, lost = 0, duplicated = 0, reordered = 0, overflowed = 0;
+};
+
+// Every client gets its own upstream socket, so the server still sees one peer per client.
+struct Session {
+    uint32_t id;
+    ENetAddress client;
+    ENetSocket socket;
+    double lastActive;
+};
+
+struct Datagram {
+    double release;
+    uint64_t order; // Keeps arrival order between datagrams released at the same time
+    bool upstream;
+    uint32_t session;
+    std::vector<uint8_t> data;
+};
+
+struct LaterRelease {
+    bool operator()(const Datagram &a, const Datagram &b) const {
+        return a.release != b.release ? a.release > b.release : a.order > b.order;
+    }
+};
+
+static std::mt19937_64 generator;
+
+bool Chance(double probability) {
+    return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(generator) < probability;
+}
+
+// Release times of the copies of a datagram that arrived now, none if it is lost.
+void Schedule(Link &link, size_t size, double now, std::vector<double> &releases) {
+    const Conditions &conditions = link.conditions;
+    releases.clear();
+
+    link.received++;
+    if (Chance(conditions.loss)) {
+        link.lost++;
+        return;
+    }
+
+    int copies = 1;
+    if (Chance(conditions.duplicate)) {
+        link.duplicated++;
+        copies = 2;
+    }
+
+    for (int i = 0; i < copies; i++) {
+        double sent = now;
+
+        // The cap delays the datagram until the link has sent everything before it, a full buffer drops it.
+        if (conditions.bandwidth > 0.0) {
+            double start = std::max(now, link.busyUntil);
+
+            if ((start - now) * conditions.bandwidth > MaxBacklogBytes) {
+                link.overflowed++;
+                continue;
+            }
+
+            sent = start + size / conditions.bandwidth;
+            link.busyUntil = sent;
+        }
+
+        double jitter = conditions.jitter * std::uniform_real_distribution<double>(-1.0, 1.0)(generator);
+        double release = sent + std::max(conditions.latency + jitter, 0.0);
+
+        if (Chance(conditions.reorder)) {
+            link.reordered++;
+            release += ReorderHold;
+        } else {
+            release = std::max(release, link.lastRelease);
+            link.lastRelease = release;
+        }
+
+        releases.push_back(release);
+    }
+}
+
+void PrintLink(const Link &link) {
+    printf("netsim: %s received %llu forwarded %llu lost %llu duplicated %llu reordered %llu overflowed %llu\n", link.name,
+           static_cast<unsigned long long>(link.received), static_cast<unsigned long long>(link.forwarded),
+           static_cast<unsigned long long>(link.lost), static_cast<unsigned long long>(link.duplicated),
+           static_cast<unsigned long long>(link.reordered), static_cast<unsigned long long>(link.overflowed));
+}
+
+bool SameAddress(const ENetAddress &a, const ENetAddress &b) {
+    return a.host == b.host && a.port == b.port;
+}
+
+int main(int argc, char **argv) {
+    int port = 25565;
+    std::string serverHost = "localhost";
+    int serverPort = 25566;
+    unsigned long long seed = 1;
+
+    Conditions conditions;
+
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find('=') == std::string::npos) {
+            args.push_back(arg);
+        } else {
+            args.push_back(arg.substr(0, arg.find('=')));
+            args.push_back(arg.substr(arg.find('=') + 1));
+        }
+    }
+
+    try {
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] == "-h" || args[i] == "--help") {
+                printf(
+                    "Usage:\n    NetSim [arguments]\n\nArguments:\n"
+                    "    -p or --port                 Port clients connect to\n"
+                    "    --server                     Host of the server\n"
+                    "    --server_port                Port of the server\n"
+                    "    --latency                    One way delay in milliseconds\n"
+                    "    --jitter                     Random delay variation in milliseconds, up to this much either way\n"
+                    "    --loss                       Percent of datagrams dropped\n"
+                    "    --duplicate                  Percent of datagrams sent twice\n"
+                    "    --reorder                    Percent of datagrams held back to arrive out of order\n"
+                    "    --bandwidth                  Cap of each direction in kilobits per second, 0 for none\n"
+                    "    --seed                       Seed of every random decision\n"
+                    "    -h or --help                 Print Help (This message) and exit\n");
+                return 0;
+            } else if (args[i] == "-p" || args[i] == "--port") {
+                port = std::stoi(args.at(++i));
+            } else if (args[i] == "--server") {
+                serverHost = args.at(++i);
+            } else if (args[i] == "--server_port") {
+                serverPort = std::stoi(args.at(++i));
+            } else if (args[i] == "--latency") {
+                conditions.latency = std::stod(args.at(++i)) / 1000.0;
+            } else if (args[i] == "--jitter") {
+                conditions.jitter = std::stod(args.at(++i)) / 1000.0;
+            } else if (args[i] == "--loss") {
+                conditions.loss = std::stod(args.at(++i)) / 100.0;
+            } else if (args[i] == "--duplicate") {
+                conditions.duplicate = std::stod(args.at(++i)) / 100.0;
+            } else if (args[i] == "--reorder") {
+                conditions.reorder = std::stod(args.at(++i)) / 100.0;
+            } else if (args[i] == "--bandwidth") {
+                conditions.bandwidth = std::stod(args.at(++i)) * 1000.0 / 8.0;
+            } else if (args[i] == "--seed") {
+                seed = std::stoull(args.at(++i));
+            }
+        }
+    } catch (...) {
+        throw std::invalid_argument("Invalid arguments");
+    }
+
+    generator.seed(seed);
+
+    if (enet_initialize() != 0) {
+        printf("Error: can't initialize enet\n");
+        return 1;
+    }
+
+    ENetAddress serverAddress = {};
+    if (enet_address_set_host(&serverAddress, serverHost.c_str()) != 0) {
+        printf("Error: can't resolve %s\n", serverHost.c_str());
+        return 1;
+    }
+    serverAddress.port = static_cast<enet_uint16>(serverPort);
+
+    ENetAddress listenAddress = {};
+    listenAddress.host = ENET_HOST_ANY;
+    listenAddress.port = static_cast<enet_uint16>(port);
+
+    ENetSocket listener = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if (listener == ENET_SOCKET_NULL || enet_socket_bind(listener, &listenAddress) < 0) {
+        printf("Error: can't listen on port %d\n", port);
+        return 1;
+    }
+    enet_socket_set_option(listener, ENET_SOCKOPT_NONBLOCK, 1);
+
+    printf("Info: forwarding port %d to %s:%d, latency %.0fms jitter %.0fms loss %.1f%% duplicate %.1f%% reorder %.1f%% bandwidth %.0fkbit/s seed %llu\n",
+           port, serverHost.c_str(), serverPort, conditions.latency * 1000.0, conditions.jitter * 1000.0, conditions.loss * 100.0,
+           conditions.duplicate * 100.0, conditions.reorder * 100.0, conditions.bandwidth * 8.0 / 1000.0, seed);
+
+    Link upstream, downstream;
+    upstream.name = "client->server";
+    upstream.conditions = conditions;
+    downstream.name = "server->client";
+    downstream.conditions = conditions;
+
+    std::vector<Session> sessions;
+    uint32_t nextSession = 0;
+
+    std::priority_queue<Datagram, std::vector<Datagram>, LaterRelease> queue;
+    uint64_t order = 0;
+
+    std::vector<uint8_t> buffer(MaxDatagram);
+    std::vector<double> releases;
+
+    auto start = std::chrono::steady_clock::now();
+    auto Now = [&start]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+    double nextStats = StatsInterval;
+
+    // Copies a received datagram into the queue once per scheduled release.
+    auto Enqueue = [&](Link &link, bool toServer, uint32_t session, size_t size, double now) {
+        Schedule(link, size, now, releases);
+
+        for (double release : releases) {
+            queue.push({release, order++, toServer, session, std::vector<uint8_t>(buffer.begin(), buffer.begin() + size)});
+        }
+    };
+
+    while (true) {
+        double now = Now();
+
+        // Sleeps until a datagram arrives or the next one is due.
+        double wait = queue.empty() ? 0.1 : std::max(queue.top().release - now, 0.0);
+        enet_uint32 timeout = static_cast<enet_uint32>(std::min(wait, 0.1) * 1000.0);
+
+        ENetSocketSet readSet;
+        ENET_SOCKETSET_EMPTY(readSet);
+        ENET_SOCKETSET_ADD(readSet, listener);
+
+        ENetSocket maxSocket = listener;
+        for (const Session &session : sessions) {
+            ENET_SOCKETSET_ADD(readSet, session.socket);
+            maxSocket = std::max(maxSocket, session.socket);
+        }
+
+        enet_socketset_select(maxSocket, &readSet, nullptr, timeout);
+        now = Now();
+
+        ENetBuffer receiveBuffer;
+        receiveBuffer.data = buffer.data();
+        receiveBuffer.dataLength = buffer.size();
+
+        ENetAddress from;
+        int received;
+
+        while ((received = enet_socket_receive(listener, &from, &receiveBuffer, 1)) > 0) {
+            auto session = std::find_if(sessions.begin(), sessions.end(), [&from](const Session &session) { return SameAddress(session.client, from); });
+
+            if (session == sessions.end()) {
+                ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+
+                ENetAddress any = {};
+                any.host = ENET_HOST_ANY;
+                any.port = 0;
+
+                if (socket == ENET_SOCKET_NULL || enet_socket_bind(socket, &any) < 0) {
+                    printf("Error: can't open a socket for a new client\n");
+                    continue;
+                }
+                enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+
+                sessions.push_back({nextSession++, from, socket, now});
+                session = sessions.end() - 1;
+
+                printf("Info: new client %x:%u\n", from.host, from.port);
+            }
+
+            session->lastActive = now;
+            Enqueue(upstream, true, session->id, static_cast<size_t>(received), now);
+        }
+
+        for (Session &session : sessions) {
+            while ((received = enet_socket_receive(session.socket, &from, &receiveBuffer, 1)) > 0) {
+                session.lastActive = now;
+                Enqueue(downstream, false, session.id, static_cast<size_t>(received), now);
+            }
+        }
+
+        // Datagrams of a session that closed meanwhile are dropped.
+        while (!queue.empty() && queue.top().release <= now) {
+            const Datagram &datagram = queue.top();
+
+            auto session = std::find_if(sessions.begin(), sessions.end(), [&datagram](const Session &session) { return session.id == datagram.session; });
+
+            if (session != sessions.end()) {
+                ENetBuffer sendBuffer;
+                sendBuffer.data = const_cast<uint8_t *>(datagram.data.data());
+                sendBuffer.dataLength = datagram.data.size();
+
+                if (datagram.upstream) {
+                    enet_socket_send(session->socket, &serverAddress, &sendBuffer, 1);
+                    upstream.forwarded++;
+                } else {
+                    enet_socket_send(listener, &session->client, &sendBuffer, 1);
+                    downstream.forwarded++;
+                }
+            }
+
+            queue.pop();
+        }
+
+        for (auto session = sessions.begin(); session != sessions.end();) {
+            if (now - session->lastActive < SessionTimeout) {
+                ++session;
+                continue;
+            }
+
+            printf("Info: client %x:%u timed out\n", session->client.host, session->client.port);
+
+            enet_socket_destroy(session->socket);
+            session = sessions.erase(session);
+        }
+
+        if (now >= nextStats) {
+            nextStats = now + StatsInterval;
+
+            PrintLink(upstream);
+            PrintLink(downstream);
+        }
+    }
+
+    enet_socket_destroy(listener);
+    enet_deinitialize();
+}
@@ -1,23 +1,78 @@
 #include <enet/enet.h>
 
+#include "../common/densitygrid.h"
+#include "../common/movement.h"
+#include "../common/netstats.h"
+#include "../common/protocol.h"
+
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <iostream>
 
-#include <sstream>
 #include <vector>
 
-void SendPacket(std::string_view data, size_t s, ENetPeer *to) {
-    ENetPacket *packet = enet_packet_create(data.data(), s, ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(to, 0, packet);
+// Traffic of all peers. Each peer also counts its own, in the NetStats its ENetPeer::data points to.
+static NetStats totalStats;
+
+void CountTraffic(TrafficDirection direction, ENetPeer *peer, enet_uint8 channel, const uint8_t *data, size_t size) {
+    TrafficKind kind = NetStats::classify(channel, data, size);
+
+    totalStats.count(direction, kind, size);
+    if (peer->data != nullptr) static_cast<NetStats *>(peer->data)->count(direction, kind, size);
 }
 
+void SendPacket(const std::vector<uint8_t> &data, ENetPeer *to, enet_uint8 channel) {
+    CountTraffic(TRAFFIC_SENT, to, channel, data.data(), data.size());
+
+    ENetPacket *packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(to, channel, packet);
+}
+
+// Same peers enet_host_broadcast sends to, so every copy is counted.
+void Broadcast(ENetHost *host, const std::vector<uint8_t> &data, enet_uint8 channel, enet_uint32 flags) {
+    for (size_t i = 0; i < host->peerCount; i++) {
+        if (host->peers[i].state != ENET_PEER_STATE_CONNECTED) continue;
+        CountTraffic(TRAFFIC_SENT, &host->peers[i], channel, data.data(), data.size());
+    }
+
+    enet_host_broadcast(host, channel, enet_packet_create(data.data(), data.size(), flags));
+}
+
+void PrintTraffic(const char *label, const NetStats &stats) {
+    printf("%s", label);
+
+    for (int kind = 0; kind < TRAFFIC_KIND_COUNT; kind++) {
+        TrafficStats sent = stats.getTraffic(TRAFFIC_SENT, static_cast<TrafficKind>(kind));
+        TrafficStats received = stats.getTraffic(TRAFFIC_RECEIVED, static_cast<TrafficKind>(kind));
+        if (sent.packets == 0 && received.packets == 0) continue;
+
+        printf("  %s %llu/%.1fkB out %llu/%.1fkB in", NetStats::getKindName(static_cast<TrafficKind>(kind)),
+               static_cast<unsigned long long>(sent.packets), sent.bytes / 1000.0,
+               static_cast<unsigned long long>(received.packets), received.bytes / 1000.0);
+    }
+
+    printf("\n");
+}
+
+// The minimap changes slowly, a few updates a second are plenty.
+const double MinimapInterval = 0.25;
+// Default seconds between stats reports, 0 turns them off.
+const double DefaultStatsInterval = 5.0;
+// Seconds of input a player may have banked on top of one tick, for inputs that arrive in bursts.
+const float InputAllowance = 0.25f;
+
 struct Ball {
     ENetPeer *client;
-    glm::vec2 pos;
-    double points;
+    glm::vec2 pos = glm::vec2(0.0f);
+    double points = 0;
     glm::vec3 color;
     bool isDead = false;
+    bool inGrid = false; // Contributes to the density grid once its first input arrived
+    uint32_t acknowledged = 0; // Last input applied, echoed in snapshots for the client to reconcile against
+    float inputBudget = InputAllowance; // Seconds of movement left, refilled by the server clock every tick
     int ID = 0;
 
 	Ball(int ID, ENetPeer *client) : ID(ID), client(client) {};
@@ -27,29 +82,11 @@ struct Ball {
         : pos(position), points(points), color(color), ID(ID){};
 };
 
-void sendPlayer(std::vector<Ball> balls, int ID, ENetPeer *client) {
-    std::string message = "";
-
-    for (Ball &ball : balls) {
-        if (ball.ID == ID) {
-            ball.isDead = true;
-            break;
-        } else {
-            message.append(std::to_string(ball.ID) + " " +
-                           std::to_string(ball.pos.x) + " " +
-                           std::to_string(ball.pos.y));
-        }
-    }
-    balls.erase(std::remove_if(balls.begin(), balls.end(),
-                               [](auto ball) { return ball.isDead; }),
-                balls.end());
-    SendPacket(message.c_str(), message.size(), client);
-}
-
 int main(int argc, char **argv) {
     uint8_t max_clients_count = 32;
     int tickrate = 32;
     int port = 25566;
+    double statsInterval = DefaultStatsInterval;
 
     std::vector<Ball> players;
 
@@ -77,12 +114,15 @@ int main(int argc, char **argv) {
                     "connect to a server.\n    -h or --help                 "
                     "Print Help (This message) and exit\n    -p or --port      "
                     "           Sets server port\n    -t or --tickrate         "
-                    "    Sets how many times per second server update events");
+                    "    Sets how many snapshots per second the server sends\n"
+                    "    -s or --stats                Seconds between traffic reports, 0 for none\n");
                 return 0;
             } else if (args[i] == "-p" || args[i] == "--port") {
                 port = std::stoi(args.at(++i));
             } else if (args[i] == "-t" || args[i] == "--tickrate") {
                 tickrate = std::stoi(args.at(++i));
+            } else if (args[i] == "-s" || args[i] == "--stats") {
+                statsInterval = std::stod(args.at(++i));
             }
         }
     } catch (...) {
@@ -105,92 +145,192 @@ int main(int argc, char **argv) {
         std::runtime_error("Error: Can't create server\n");
     }
 
-    bool run;
+    const double TickInterval = 1.0 / std::max(tickrate, 1);
+
+    std::vector<uint8_t> IDs;
 
-    tickrate *= 0.001f;
+    DensityGrid density;
 
-    std::stringstream result;
+    // Reused for every outgoing message.
+    std::vector<uint8_t> message;
+    std::vector<EntityState> entities;
 
-    std::vector<uint8_t> IDs;
+    // Decoded input batch of the packet being handled.
+    std::array<InputMessage, MaxInputBatch> inputs;
+
+    uint32_t tick = 0;
+
+    // Per player ID, a slot is reset when its ID is handed out again.
+    std::vector<NetStats> peerStats(max_clients_count + 1);
 
     for(int x = 0; x <= max_clients_count; x++) {
         IDs.push_back(x);
     }
 
-    while (true) {
-        ENetEvent event = {};
-        while (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-                case ENET_EVENT_TYPE_CONNECT: {
-                    printf("A new client connected from %x:%u.\n",
-                           event.peer->address.host, event.peer->address.port);
-                    
-                    std::string temp = std::to_string(IDs.back());
-
-                    players.push_back(Ball(IDs.back(), event.peer));
-                    
-                    IDs.pop_back();
-					
-                    SendPacket(temp.c_str(), temp.size() + 1, event.peer);
-                    break;
-                }
-                case ENET_EVENT_TYPE_RECEIVE: {
-                    // printf(
-                    //     "A packet of length %u containing %s was received on "
-                    //     "channel %u.\n",
-                    //     event.packet->dataLength, event.packet->data,
-                    //     event.channelID);
-                    std::string temp;
+    auto handleEvent = [&](ENetEvent &event) {
+        switch (event.type) {
+            case ENET_EVENT_TYPE_CONNECT: {
+                printf("A new client connected from %x:%u.\n",
+                       event.peer->address.host, event.peer->address.port);
+
+                players.push_back(Ball(IDs.back(), event.peer));
+
+                peerStats[IDs.back()].reset();
+                event.peer->data = &peerStats[IDs.back()];
+
+                message.clear();
+                writeWelcome(message, {IDs.back(), static_cast<uint16_t>(tickrate)});
+                SendPacket(message, event.peer, CHANNEL_CONTROL);
 
-                    temp.append((char *)event.packet->data);
+                IDs.pop_back();
 
-                    float x, y;
-                    int id;
+                // Deltas only carry changed rows, a new client starts from the whole grid.
+                message.clear();
+                density.encodeFull(message);
+                SendPacket(message, event.peer, CHANNEL_MINIMAP);
+                break;
+            }
+            case ENET_EVENT_TYPE_RECEIVE: {
+                CountTraffic(TRAFFIC_RECEIVED, event.peer, event.channelID, event.packet->data, event.packet->dataLength);
 
-                    sscanf(temp.c_str(), "%i %f %f", &id, &x, &y);
+                size_t count = 0;
 
+                if (readInputs(event.packet->data, event.packet->dataLength, inputs.data(), inputs.size(), count)) {
                     for (Ball &ball : players) {
-                        if (ball.ID == id) {
-                            ball.pos.x = x;
-                            ball.pos.y = y;
-                            break;
+                        if (ball.client != event.peer) continue;
+
+                        for (size_t i = 0; i < count; i++) {
+                            const InputMessage &input = inputs[i];
+
+                            // Reliable and ordered, anything that is not newer is a duplicate.
+                            if (input.input.sequence <= ball.acknowledged) continue;
+
+                            // The same movement code the client predicts with, the server has the final word.
+                            PlayerState state;
+                            state.count = 1;
+                            state.cells[0] = {ball.pos, input.points};
+
+                            // Input time is paid from the budget, a client cannot move for longer than has passed.
+                            MoveInput move = input.input;
+                            move.delta = std::min(glm::clamp(move.delta, 0.0f, MaxInputDelta), ball.inputBudget);
+                            ball.inputBudget -= move.delta;
+
+                            applyInput(state, move);
+                            glm::vec2 position = state.cells[0].position;
+
+                            // Only the difference goes into the grid, the rest of the world is untouched.
+                            if (ball.inGrid) {
+                                density.update(ball.pos, ball.points, position, input.points);
+                            } else {
+                                density.add(position, input.points);
+                                ball.inGrid = true;
+                            }
+
+                            ball.pos = position;
+                            ball.points = input.points;
+                            ball.acknowledged = input.input.sequence;
                         }
+                        break;
                     }
-
-                    enet_packet_destroy(event.packet);
-
-					break;
                 }
 
-                case ENET_EVENT_TYPE_DISCONNECT: {
-                    printf("client disconnected.\n");
+                enet_packet_destroy(event.packet);
+                break;
+            }
+            case ENET_EVENT_TYPE_DISCONNECT: {
+                printf("client disconnected.\n");
+                event.peer->data = nullptr;
 
-                    for (Ball &ball : players) {
-						if(ball.client == event.peer) {
-							ball.isDead = true;
-                            IDs.push_back(ball.ID);
-                        }
+                for (Ball &ball : players) {
+                    if (ball.client == event.peer) {
+                        ball.isDead = true;
+                        IDs.push_back(ball.ID);
+
+                        if (ball.inGrid) density.remove(ball.pos, ball.points);
                     }
+                }
 
-					players.erase(std::remove_if(players.begin(), 
+                players.erase(std::remove_if(players.begin(),
                               players.end(),
                               [](auto ball) { return ball.isDead; }),
-                	players.end());
+                    players.end());
 
-                    break;
-                }
+                break;
             }
-            result.str(std::string());
+            default:
+                break;
+        }
+    };
 
-            for (Ball &ball : players) {
-                result << std::to_string(ball.ID) << " " << std::to_string(ball.pos.x) << " " << std::to_string(ball.pos.y) << " ";
+    auto start = std::chrono::steady_clock::now();
+    double nextTick = 0.0, nextMinimap = 0.0, nextStats = statsInterval;
+
+    while (true) {
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Waits in the socket until the next tick is due, packets are handled as soon as they arrive.
+        enet_uint32 timeout = now < nextTick ? static_cast<enet_uint32>((nextTick - now) * 1000.0) : 0;
+
+        ENetEvent event = {};
+        if (enet_host_service(server, &event, timeout) > 0) {
+            handleEvent(event);
+
+            while (enet_host_check_events(server, &event) > 0) {
+                handleEvent(event);
             }
+        }
+
+        now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (now < nextTick) continue;
+
+        // Missed ticks are skipped rather than sent in a burst, but still counted: clients take tick * TickInterval
+        // as the server time, it has to keep up with the clock after a stall.
+        uint32_t elapsed = static_cast<uint32_t>(std::floor((now - nextTick) / TickInterval)) + 1;
+        nextTick += elapsed * TickInterval;
+        tick += elapsed;
+
+        for (Ball &ball : players) {
+            ball.inputBudget = std::min(ball.inputBudget + static_cast<float>(elapsed * TickInterval), static_cast<float>(TickInterval) + InputAllowance);
+        }
+
+        entities.clear();
+        for (Ball &ball : players) {
+            if (!ball.inGrid) continue;
+            entities.push_back({static_cast<uint8_t>(ball.ID), ball.pos, static_cast<float>(ball.points), ball.acknowledged});
+        }
+
+        message.clear();
+        writeSnapshot(message, tick, entities.data(), entities.size());
+        Broadcast(server, message, CHANNEL_SNAPSHOTS, 0);
+
+        if (now >= nextMinimap) {
+            nextMinimap = now + MinimapInterval;
+
+            message.clear();
+            if (density.encodeDelta(message)) {
+                Broadcast(server, message, CHANNEL_MINIMAP, ENET_PACKET_FLAG_RELIABLE);
+            }
+        }
+
+        if (statsInterval > 0.0 && now >= nextStats) {
+            nextStats = now + statsInterval;
+
+            PrintTraffic("stats: total", totalStats);
 
             for (Ball &ball : players) {
-                SendPacket(result.str(), result.view().size() + 1, ball.client);
+                NetStats &stats = peerStats[ball.ID];
+                stats.sampleLink(ball.client);
+
+                LinkStats link = stats.getLink();
+                printf("stats: peer %d rtt %ums (+-%u) loss %.1f%% throttle %.0f%%\n", ball.ID, link.roundTripTime,
+                       link.roundTripTimeVariance, link.packetLoss * 100.0f, link.throttle * 100.0f);
+
+                char label[32];
+                snprintf(label, sizeof(label), "stats: peer %d", ball.ID);
+                PrintTraffic(label, stats);
             }
         }
     }
 
     enet_host_destroy(server);
-}
\ No newline at end of file
+}
@@ -0,0 +1,298 @@
+#include "clientcore.h"
+#include "engine/util/time.h"
+
+#include <iostream>
+
+ClientCore::ClientCore(const std::string &serverHost, uint16_t port, float inputRate)
+    : hostName(serverHost), port(port), sendInterval(1.0 / inputRate), running(false), threaded(false),
+      host(nullptr), server(nullptr), connected(false), welcomed(false), nextSend(0.0),
+      session(0), lastSnapshot(0), reconciledTick(0), minimapRevisions(), changedRows(0), pointer(0.0f) {
+    received.resize(SnapshotBuffer::MaxEntities);
+}
+
+ClientCore::~ClientCore() {
+    stop();
+}
+
+bool ClientCore::start(bool threaded) {
+    if(host != nullptr) return false;
+
+    host = enet_host_create(NULL, 1, 0, 0, 0);
+    if(host == nullptr) {
+        std::cout << "An error occurred while trying to create an ENet client host.\n";
+        return false;
+    }
+
+    ENetAddress address = {};
+    enet_address_set_host(&address, hostName.c_str());
+    address.port = port;
+
+    server = enet_host_connect(host, &address, CHANNEL_COUNT, 0);
+    if(server == nullptr) {
+        std::cout << "Wasn't able to initialize connection\n";
+
+        enet_host_destroy(host);
+        host = nullptr;
+        return false;
+    }
+
+    this->threaded = threaded;
+    running = true;
+
+    if(threaded) {
+        // Lets the networking thread sleep on its socket between sends, update() ends the wait with an input.
+        wakeup.create();
+        thread = std::thread(&ClientCore::run, this);
+    }
+
+    return true;
+}
+
+void ClientCore::stop() {
+    if(!running) return;
+    running = false;
+
+    if(threaded) {
+        wakeup.signal();
+        thread.join();
+        wakeup.destroy();
+    }
+
+    disconnect();
+}
+
+void ClientCore::disconnect() {
+    if(host == nullptr) return;
+
+    enet_peer_reset(server);
+    enet_host_destroy(host);
+
+    host = nullptr;
+    server = nullptr;
+}
+
+void ClientCore::run() {
+    while(running) {
+        uint32_t timeout = pump();
+
+        // With nothing pending, the first input posted ends the wait, so it goes out right away
+        // instead of a send interval later.
+        if(pending.empty()) {
+            wakeup.arm();
+            if(inputs.size() > 0 || !running) timeout = 0;
+        }
+
+        wakeup.wait(host->socket, timeout);
+    }
+}
+
+uint32_t ClientCore::pump() {
+    ENetEvent event;
+
+    // Everything that arrived since the last round, without blocking.
+    while(enet_host_service(host, &event, 0) > 0) {
+        switch(event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                std::cout << "Got a connection!\n";
+                connected = true;
+                break;
+
+            case ENET_EVENT_TYPE_RECEIVE:
+                receive(event);
+                enet_packet_destroy(event.packet);
+                break;
+
+            case ENET_EVENT_TYPE_DISCONNECT:
+                std::cout << (connected ? "Server Disconected\n" : "Wasn't able to connect\n");
+
+                connected = false;
+                welcomed = false;
+                pending.clear();
+
+                state.welcomed = false;
+                world.getWriteBuffer() = state;
+                world.publish();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    stats.sampleLink(server);
+
+    // Inputs made before the server knows us are dropped, the first acknowledgement resyncs the prediction.
+    InputMessage input;
+    while(pending.size() < MaxInputBatch && inputs.pop(input)) {
+        if(welcomed) pending.push_back(input);
+    }
+
+    double now = Brainstorm::Timer::now();
+
+    if(!pending.empty() && (now >= nextSend || pending.size() == MaxInputBatch)) {
+        message.clear();
+        writeInputs(message, pending.data(), pending.size());
+        stats.count(TRAFFIC_SENT, TRAFFIC_INPUT, message.size());
+
+        enet_peer_send(server, CHANNEL_CONTROL, enet_packet_create(message.data(), message.size(), ENET_PACKET_FLAG_RELIABLE));
+        // Out now rather than with the next service.
+        enet_host_flush(host);
+
+        pending.clear();
+        // Keeps the cadence, but a late send does not turn into a burst of them.
+        nextSend = glm::max(nextSend + sendInterval, now);
+    }
+
+    if(pending.empty()) return IdleWait;
+    return static_cast<uint32_t>(glm::ceil(glm::max(nextSend - Brainstorm::Timer::now(), 0.0) * 1000.0));
+}
+
+void ClientCore::receive(const ENetEvent &event) {
+    stats.count(TRAFFIC_RECEIVED, event.channelID, event.packet->data, event.packet->dataLength);
+    bool changed = false;
+
+    if(event.channelID == CHANNEL_MINIMAP) {
+        uint64_t rows = DensityGrid::decode(event.packet->data, event.packet->dataLength, state.minimap.data());
+
+        for(int row = 0; row < DensityGrid::Size; row++) {
+            if(rows & (uint64_t(1) << row)) state.minimapRevisions[row]++;
+        }
+
+        changed = rows != 0;
+    } else if(event.channelID == CHANNEL_SNAPSHOTS) {
+        // Timed here rather than on the game side, the jitter estimate needs the arrival time.
+        uint32_t tick = 0;
+        size_t count = 0;
+
+        if(readSnapshot(event.packet->data, event.packet->dataLength, tick, received.data(), received.size(), count)) {
+            state.tick = tick;
+            state.entities.assign(received.begin(), received.begin() + count);
+            state.receiveTime = Brainstorm::Timer::now();
+            state.snapshot++;
+
+            changed = true;
+        }
+    } else {
+        WelcomeMessage welcome;
+
+        if(readWelcome(event.packet->data, event.packet->dataLength, welcome)) {
+            state.id = welcome.id;
+            state.tickRate = welcome.tickRate;
+            state.session++;
+            state.welcomed = true;
+
+            welcomed = true;
+            changed = true;
+        }
+    }
+
+    if(changed) {
+        world.getWriteBuffer() = state;
+        world.publish();
+    }
+}
+
+void ClientCore::spawn(const PlayerState &state) {
+    prediction.reset(state);
+}
+
+void ClientCore::update(InputSource &input, float delta, double now) {
+    if(running && !threaded) pump();
+
+    // Stays put until the next update, whatever the network side publishes meanwhile.
+    world.update();
+    const WorldState &state = world.getReadBuffer();
+
+    if(state.session != session) {
+        session = state.session;
+
+        snapshots.reset();
+        snapshots.setTickRate(state.tickRate);
+    }
+
+    if(state.snapshot != lastSnapshot) {
+        lastSnapshot = state.snapshot;
+        snapshots.push(state.tick, state.entities.data(), state.entities.size(), state.receiveTime);
+    }
+
+    for(int row = 0; row < DensityGrid::Size; row++) {
+        if(state.minimapRevisions[row] == minimapRevisions[row]) continue;
+
+        minimapRevisions[row] = state.minimapRevisions[row];
+        changedRows |= uint64_t(1) << row;
+    }
+
+    EntityState own;
+    uint32_t tick;
+
+    // Once per snapshot, rewinds to the server position and replays the inputs it has not seen yet.
+    if(snapshots.getLatest(state.id, own, tick) && tick != reconciledTick) {
+        reconciledTick = tick;
+
+        PlayerState authoritative;
+        authoritative.count = 1;
+        authoritative.cells[0] = {own.position, own.points};
+
+        prediction.reconcile(authoritative, own.acknowledged);
+    }
+
+    pointer = input.getPointer();
+    MoveInput move = prediction.record(pointer, delta);
+
+    // Full only if the network side stalls. The input is lost, the next acknowledgement corrects for it.
+    inputs.push({move, prediction.getState().cells[0].points});
+    wakeup.signal();
+
+    prediction.update(delta);
+}
+
+void ClientCore::setPoints(size_t cell, float points) {
+    prediction.setPoints(cell, points);
+}
+
+const std::vector<EntityState> &ClientCore::sampleRemotes(double now) {
+    size_t count = snapshots.sample(now);
+    const EntityState *entities = snapshots.getEntities();
+
+    remotes.clear();
+    for(size_t i = 0; i < count; i++) {
+        if(entities[i].id != getId()) remotes.push_back(entities[i]);
+    }
+
+    return remotes;
+}
+
+uint64_t ClientCore::takeMinimapRows() {
+    uint64_t rows = changedRows;
+    changedRows = 0;
+
+    return rows;
+}
+
+const uint8_t *ClientCore::getMinimap() const {
+    return world.getReadBuffer().minimap.data();
+}
+
+bool ClientCore::isWelcomed() const {
+    return world.getReadBuffer().welcomed;
+}
+
+uint8_t ClientCore::getId() const {
+    return world.getReadBuffer().id;
+}
+
+glm::vec2 ClientCore::getPointer() const {
+    return pointer;
+}
+
+const Prediction &ClientCore::getPrediction() const {
+    return prediction;
+}
+
+const SnapshotBuffer &ClientCore::getSnapshots() const {
+    return snapshots;
+}
+
+const NetStats &ClientCore::getStats() const {
+    return stats;
+}
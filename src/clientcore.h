@@ -0,0 +1,132 @@
+#pragma once
+#include "snapshotbuffer.h"
+#include "prediction.h"
+#include "socketwakeup.h"
+#include "engine/util/triplebuffer.h"
+#include "engine/util/spscqueue.h"
+#include "../common/netstats.h"
+#include "../common/protocol.h"
+
+#include <enet/enet.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where a player wants to go: the mouse for a person, a script for a bot.
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // Offset from the center of the player's view in half view heights, what MoveInput expects.
+    virtual glm::vec2 getPointer() = 0;
+};
+
+// Everything a client does apart from drawing: the connection, the world as the server sends it, and the
+// prediction of the local player. Needs no window, so bots and tests run the same code as the game.
+// ENet has to be initialized by the process first.
+//
+// The network side runs on a thread of its own, or, unthreaded, is pumped by update() on the caller's
+// thread, which lets one thread drive many clients.
+class ClientCore {
+public:
+    // Everything the network side knows about the world, published whole after every message. Sized by what
+    // the server sends, copies only reallocate when a snapshot outgrows the ones before.
+    struct WorldState {
+        uint32_t session = 0; // Counts welcomes, snapshot ticks start over with every one
+        bool welcomed = false; // Cleared when the server goes away
+        uint8_t id = 0;
+        uint16_t tickRate = 0;
+
+        // Newest snapshot and when it arrived. Counted, so the game side feeds each one to its buffer only once.
+        uint64_t snapshot = 0;
+        uint32_t tick = 0;
+        double receiveTime = 0.0;
+        std::vector<EntityState> entities;
+
+        // Quantized minimap cells, Size rows of Size from the bottom of the world up, as DensityGrid::getRow().
+        std::array<uint8_t, DensityGrid::Size * DensityGrid::Size> minimap = {};
+        // Bumped whenever a row changes, the game side reports the rows whose revision it has not seen.
+        std::array<uint32_t, DensityGrid::Size> minimapRevisions = {};
+    };
+
+    // Longest sleep of the networking thread with nothing to send. ENet only resends and pings while serviced.
+    static const uint32_t IdleWait = 15;
+private:
+    std::string hostName;
+    uint16_t port;
+    double sendInterval;
+
+    // Network to game side, the game side always takes the latest complete state without waiting.
+    Brainstorm::TripleBuffer<WorldState> world;
+    // Game to network side, one input per update.
+    Brainstorm::SpscQueue<InputMessage, 256> inputs;
+
+    SocketWakeup wakeup;
+    NetStats stats;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    bool threaded;
+
+    // Network side.
+    ENetHost *host;
+    ENetPeer *server;
+    bool connected, welcomed;
+
+    WorldState state;
+    std::vector<EntityState> received; // Decoding scratch, room for the most entities a snapshot may carry
+    std::vector<InputMessage> pending; // Waiting for the next send, coalesced into one packet
+    std::vector<uint8_t> message;
+    double nextSend;
+
+    // Game side.
+    SnapshotBuffer snapshots;
+    uint32_t session;
+    uint64_t lastSnapshot;
+    uint32_t reconciledTick;
+    std::array<uint32_t, DensityGrid::Size> minimapRevisions;
+    uint64_t changedRows;
+
+    Prediction prediction;
+    glm::vec2 pointer;
+
+    std::vector<EntityState> remotes;
+
+    void run();
+    // One round of the network side. Returns how long it may sleep before the next one, in milliseconds.
+    uint32_t pump();
+    void receive(const ENetEvent &event);
+    void disconnect();
+public:
+    ClientCore(const std::string &serverHost, uint16_t port, float inputRate = 60.0f);
+    ~ClientCore();
+
+    bool start(bool threaded = true);
+    void stop();
+
+    void spawn(const PlayerState &state);
+
+    // One frame: takes the newest state from the network side, reconciles, then records and sends the input.
+    void update(InputSource &input, float delta, double now);
+
+    // Eating is still up to the client, the mass it reports comes from here.
+    void setPoints(size_t cell, float points);
+
+    // Other players interpolated to now, without the local one.
+    const std::vector<EntityState> &sampleRemotes(double now);
+
+    // Rows of the minimap changed since the last call.
+    uint64_t takeMinimapRows();
+    // DensityGrid::Size rows of DensityGrid::Size cells.
+    const uint8_t *getMinimap() const;
+
+    bool isWelcomed() const;
+    uint8_t getId() const;
+    glm::vec2 getPointer() const;
+
+    const Prediction &getPrediction() const;
+    const SnapshotBuffer &getSnapshots() const;
+    const NetStats &getStats() const;
+};
@@ -2,13 +2,27 @@
 #include "io/window.h"
 #include "io/logger.h"
 
+#include "graphics/statecache.h"
 #include "graphics/mesh.h"
 #include "graphics/shader.h"
 #include "graphics/texture.h"
+#include "graphics/texturearray.h"
+#include "graphics/texturecache.h"
+#include "graphics/textureloader.h"
 #include "graphics/framebuffer.h"
+#include "graphics/font.h"
+#include "graphics/renderthread.h"
+#include "graphics/gputimer.h"
+#include "graphics/particles.h"
 
 #include "util/time.h"
+#include "util/pacer.h"
+#include "util/profiler.h"
+#include "util/radixsort.h"
+#include "util/mappedfile.h"
 #include "util/maths.h"
 #include "util/physics.h"
+#include "util/triplebuffer.h"
+#include "util/spscqueue.h"
 
 namespace BS = Brainstorm;
\ No newline at end of file
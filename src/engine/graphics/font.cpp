@@ -0,0 +1,191 @@
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "font.h"
+#include <stb_truetype.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace Brainstorm {
+	static const int Padding = 6;
+	static const unsigned char OnEdge = 128;
+
+	inline static int getCharacterIndex(char character) {
+		int index = static_cast<unsigned char>(character) - Font::FirstCharacter;
+		return index >= 0 && index < Font::CharacterCount ? index : '?' - Font::FirstCharacter;
+	}
+
+	Font::Font(const char* location, float pixelHeight, GLsizei atlasSize)
+			: id(0), atlasSize(atlasSize), pixelHeight(pixelHeight), ascent(0.0f), descent(0.0f), distanceRange(0.0f) {
+		this->glyphs = {};
+		this->kerning = {};
+
+		std::ifstream file(location, std::ios::binary);
+		if (!file.is_open()) {
+			Logger::error("Could not load font file: \"%s\"", location);
+			return;
+		}
+
+		std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		stbtt_fontinfo info;
+		if (!stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0))) {
+			Logger::error("Could not parse font file: \"%s\"", location);
+			return;
+		}
+
+		float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+
+		int ascent, descent, lineGap;
+		stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+
+		this->ascent = ascent * scale / pixelHeight;
+		this->descent = -descent * scale / pixelHeight;
+
+		// A full byte spans the padding on both sides of the edge.
+		const float PixelDistanceScale = static_cast<float>(OnEdge) / Padding;
+		this->distanceRange = 255.0f / PixelDistanceScale / pixelHeight;
+
+		std::vector<unsigned char> atlas(static_cast<size_t>(atlasSize) * atlasSize, 0);
+		int penX = 1, penY = 1, rowHeight = 0;
+
+		for (int i = 0; i < CharacterCount; i++) {
+			int character = FirstCharacter + i;
+			Glyph& glyph = this->glyphs[i];
+
+			int advance, bearing;
+			stbtt_GetCodepointHMetrics(&info, character, &advance, &bearing);
+			glyph.advance = advance * scale / pixelHeight;
+
+			for (int j = 0; j < CharacterCount; j++) {
+				this->kerning[i * CharacterCount + j] = stbtt_GetCodepointKernAdvance(&info, character, FirstCharacter + j) * scale / pixelHeight;
+			}
+
+			int width, height, offsetX, offsetY;
+			unsigned char* sdf = stbtt_GetCodepointSDF(&info, scale, character, Padding, OnEdge, PixelDistanceScale, &width, &height, &offsetX, &offsetY);
+
+			// Whitespace has no bitmap, only an advance.
+			if (sdf == nullptr) continue;
+
+			// Shelf packing, glyphs are close enough in height for it to waste little.
+			if (penX + width + 1 > atlasSize) {
+				penX = 1;
+				penY += rowHeight + 1;
+				rowHeight = 0;
+			}
+			if (penY + height + 1 > atlasSize) {
+				Logger::error("Font atlas of %dx%d is too small for \"%s\" at %.0f pixels.", atlasSize, atlasSize, location, pixelHeight);
+				stbtt_FreeSDF(sdf, nullptr);
+				break;
+			}
+
+			for (int y = 0; y < height; y++) {
+				std::copy(sdf + y * width, sdf + (y + 1) * width, atlas.begin() + static_cast<size_t>(penY + y) * atlasSize + penX);
+			}
+			stbtt_FreeSDF(sdf, nullptr);
+
+			glyph.offset = glm::vec2(offsetX, -offsetY - height) / pixelHeight;
+			glyph.size = glm::vec2(width, height) / pixelHeight;
+			glyph.uv = glm::vec4(penX, penY, penX + width, penY + height) / static_cast<float>(atlasSize);
+
+			penX += width + 1;
+			rowHeight = std::max(rowHeight, height);
+		}
+
+		glGenTextures(1, &this->id);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, this->id);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, atlasSize, atlasSize);
+
+		// Rows of a single channel texture are not 4 byte aligned.
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, atlasSize, atlasSize, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	Font::~Font() {
+		this->destroy();
+	}
+
+	void Font::layout(std::string_view text, ShapedText& shaped) const {
+		shaped.quads.clear();
+		shaped.quads.reserve(text.size());
+
+		float pen = 0.0f;
+		int previous = -1;
+
+		for (char character : text) {
+			int index = getCharacterIndex(character);
+			const Glyph& glyph = this->glyphs[index];
+
+			if (previous >= 0) {
+				pen += this->kerning[previous * CharacterCount + index];
+			}
+
+			if (glyph.size.x > 0.0f) {
+				shaped.quads.push_back({ glm::vec2(pen, 0.0f) + glyph.offset, glyph.size, glyph.uv });
+			}
+
+			pen += glyph.advance;
+			previous = index;
+		}
+
+		shaped.width = pen;
+	}
+
+	const ShapedText& Font::shape(std::string_view text) {
+		auto found = this->cache.find(text);
+		if (found != this->cache.end()) {
+			this->entries.splice(this->entries.begin(), this->entries, found->second);
+			return found->second->shaped;
+		}
+
+		// The least recently used entry is taken over by the new text, its storage reused.
+		if (this->entries.size() >= CacheLimit) {
+			this->cache.erase(this->entries.back().text);
+			this->entries.splice(this->entries.begin(), this->entries, std::prev(this->entries.end()));
+		} else {
+			this->entries.emplace_front();
+		}
+
+		CacheEntry& entry = this->entries.front();
+		entry.text.assign(text);
+		this->layout(entry.text, entry.shaped);
+
+		this->cache.emplace(entry.text, this->entries.begin());
+		return entry.shaped;
+	}
+
+	const Glyph& Font::getGlyph(char character) const {
+		return this->glyphs[getCharacterIndex(character)];
+	}
+
+	float Font::getAscent() const {
+		return this->ascent;
+	}
+	float Font::getDescent() const {
+		return this->descent;
+	}
+	float Font::getDistanceRange() const {
+		return this->distanceRange;
+	}
+
+	void Font::use(GLint index) const {
+		GLStateCache::bindTexture(GL_TEXTURE_2D, this->id, index);
+	}
+	void Font::destroy() {
+		if (this->id == 0) return;
+
+		GLStateCache::forgetTexture(this->id);
+		glDeleteTextures(1, &this->id);
+		this->id = 0;
+	}
+
+	GLuint Font::getId() const {
+		return this->id;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "statecache.h"
+#include "../io/logger.h"
+
+namespace Brainstorm {
+	// Metrics are in em, one em being the pixel height the atlas was rasterized at.
+	struct Glyph {
+		float advance = 0.0f;
+		glm::vec2 offset = glm::vec2(0.0f); // bottom left corner relative to the pen, y up
+		glm::vec2 size = glm::vec2(0.0f);
+		glm::vec4 uv = glm::vec4(0.0f); // left, top, right, bottom in the atlas
+	};
+
+	struct TextQuad {
+		glm::vec2 position, size;
+		glm::vec4 uv;
+	};
+
+	// Laid out string, the pen starts at (0, 0) on the baseline.
+	struct ShapedText {
+		std::vector<TextQuad> quads;
+		float width = 0.0f;
+	};
+
+	// Printable ASCII rasterized once as signed distance fields into a single channel atlas,
+	// so text stays sharp at any scale. Anything outside the range is drawn as '?'.
+	class Font {
+	public:
+		static const int FirstCharacter = 32;
+		static const int CharacterCount = 95;
+		static const size_t CacheLimit = 4096;
+	private:
+		GLuint id;
+		GLsizei atlasSize;
+
+		float pixelHeight, ascent, descent;
+		float distanceRange; // in em, the distance covered from 0 to 255 in the atlas
+
+		std::array<Glyph, CharacterCount> glyphs;
+		std::array<float, CharacterCount * CharacterCount> kerning;
+
+		struct CacheEntry {
+			std::string text;
+			ShapedText shaped;
+		};
+
+		// Most recently used first. The map is keyed by the text of the entries, list nodes never move.
+		std::list<CacheEntry> entries;
+		std::unordered_map<std::string_view, std::list<CacheEntry>::iterator> cache;
+	public:
+		Font(const char* location, float pixelHeight = 48.0f, GLsizei atlasSize = 512);
+		~Font();
+
+		// Lays text out into shaped, reusing its storage. For text that is kept and only redone when it changes.
+		void layout(std::string_view text, ShapedText& shaped) const;
+
+		// Cached by string, beyond CacheLimit the least recently used entry is evicted. The reference stays valid
+		// until CacheLimit other strings have been shaped. Not thread safe, all shaping has to happen on one thread.
+		const ShapedText& shape(std::string_view text);
+
+		const Glyph& getGlyph(char character) const;
+
+		float getAscent() const;
+		float getDescent() const;
+		float getDistanceRange() const;
+
+		void use(GLint index = 0) const;
+		void destroy();
+
+		GLuint getId() const;
+	};
+}
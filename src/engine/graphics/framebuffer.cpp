@@ -4,7 +4,7 @@
 #include <glm/glm.hpp>
 
 namespace Brainstorm {
-    Attachment::Attachment(AttachmentType type, GLint filter, GLint clamp) : texture(0), type(type), filter(filter), clamp(clamp) {}
+    Attachment::Attachment(AttachmentType type, GLint filter, GLint clamp, bool mipmaps) : texture(0), type(type), filter(filter), clamp(clamp), mipmaps(mipmaps) {}
 
     void FrameBuffer::createAttachments() {
         bool hasDepthAttachment = false;
@@ -15,7 +15,7 @@ namespace Brainstorm {
             Attachment& attachment = this->attachments[i];
 
             glGenTextures(1, &attachment.texture);
-            glBindTexture(GL_TEXTURE_2D, attachment.texture);
+            GLStateCache::bindTexture(GL_TEXTURE_2D, attachment.texture);
 
             GLint internalFormat = 0;
 
@@ -63,10 +63,10 @@ namespace Brainstorm {
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, attachment.clamp);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, attachment.clamp);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, attachment.filter - GL_NEAREST + GL_NEAREST_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, attachment.mipmaps ? attachment.filter - GL_NEAREST + GL_NEAREST_MIPMAP_LINEAR : attachment.filter);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, attachment.filter);
             
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, this->width, this->height, 0, format, type, nullptr);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, this->capacityWidth, this->capacityHeight, 0, format, type, nullptr);
 
             glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentId, GL_TEXTURE_2D, attachment.texture, 0);
             this->attachments[i] = attachment;
@@ -77,7 +77,7 @@ namespace Brainstorm {
         if (!hasDepthAttachment) {
             glGenRenderbuffers(1, &this->depthId);
             glBindRenderbuffer(GL_RENDERBUFFER, this->depthId);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->width, this->height);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->capacityWidth, this->capacityHeight);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depthId);
         }
 
@@ -85,12 +85,12 @@ namespace Brainstorm {
     }
 
     FrameBuffer::FrameBuffer(const std::vector<Attachment>& attachments, GLsizei width, GLsizei height)
-            : attachments(attachments), width(width), height(height) {
+            : attachments(attachments), depthId(0), width(width), height(height), capacityWidth(width), capacityHeight(height) {
         glGenFramebuffers(1, &this->id);
-        glBindFramebuffer(GL_FRAMEBUFFER, this->id);
+        GLStateCache::bindFramebuffer(this->id);
 
         this->createAttachments();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLStateCache::bindFramebuffer(0);
     }
 
     FrameBuffer::~FrameBuffer() {
@@ -98,52 +98,74 @@ namespace Brainstorm {
     }
 
     void FrameBuffer::use() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, this->id);
-        glViewport(0, 0, this->width, this->height);
+        GLStateCache::bindFramebuffer(this->id);
+        GLStateCache::setViewport(0, 0, this->width, this->height);
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
     void FrameBuffer::drop() const {
         for (const Attachment& attachment : this->attachments) {
-            glBindTexture(GL_TEXTURE_2D, attachment.texture);
+            if (!attachment.mipmaps) continue;
+
+            GLStateCache::bindTexture(GL_TEXTURE_2D, attachment.texture);
             glGenerateMipmap(GL_TEXTURE_2D);
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, Window::getFrameBufferWidth(), Window::getFrameBufferHeight());
+        GLStateCache::bindFramebuffer(0);
+        GLStateCache::setViewport(0, 0, Window::getFrameBufferWidth(), Window::getFrameBufferHeight());
     }
     void FrameBuffer::drop(GLsizei previousWidth, GLsizei previousHeight) const {
         for (const Attachment& attachment : this->attachments) {
-            glBindTexture(GL_TEXTURE_2D, attachment.texture);
+            if (!attachment.mipmaps) continue;
+
+            GLStateCache::bindTexture(GL_TEXTURE_2D, attachment.texture);
             glGenerateMipmap(GL_TEXTURE_2D);
         }
         
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, previousWidth, previousHeight);
+        GLStateCache::bindFramebuffer(0);
+        GLStateCache::setViewport(0, 0, previousWidth, previousHeight);
     }
-    void FrameBuffer::clear() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    void FrameBuffer::clear() {
+        if (this->id == 0) return;
+
+        GLStateCache::bindFramebuffer(0);
 
         for (const Attachment& attachment : this->attachments) {
+            GLStateCache::forgetTexture(attachment.texture);
             glDeleteTextures(1, &attachment.texture);
         }
         
         glDeleteRenderbuffers(1, &this->depthId);
+        GLStateCache::forgetFramebuffer(this->id);
         glDeleteFramebuffers(1, &this->id);
+
+        this->id = 0;
+        this->depthId = 0;
     }
     void FrameBuffer::resize(GLsizei width, GLsizei height) {
+        this->width = width;
+        this->height = height;
+
+        if (width <= this->capacityWidth && height <= this->capacityHeight) return;
+
         for (const Attachment& attachment : this->attachments) {
+            GLStateCache::forgetTexture(attachment.texture);
             glDeleteTextures(1, &attachment.texture);
         }
         glDeleteRenderbuffers(1, &this->depthId);
+        this->depthId = 0;
 
-        this->use();
+        GLStateCache::bindFramebuffer(this->id);
 
-        this->width = width;
-        this->height = height;
+        // Never shrink the other axis, a window flipping between two shapes would otherwise reallocate every time.
+        this->capacityWidth = glm::max(this->capacityWidth, width);
+        this->capacityHeight = glm::max(this->capacityHeight, height);
 
         this->createAttachments();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLStateCache::bindFramebuffer(0);
+    }
+    GLuint FrameBuffer::getId() const {
+        return this->id;
     }
     GLint FrameBuffer::getTexture(size_t attachment) const {
         if (attachment >= this->attachments.size()) return 0;
@@ -163,4 +185,13 @@ namespace Brainstorm {
             static_cast<float>(this->height)
         );
     }
+    glm::ivec2 FrameBuffer::getCapacity() const {
+        return glm::ivec2(this->capacityWidth, this->capacityHeight);
+    }
+    glm::vec2 FrameBuffer::getRegionScale() const {
+        return glm::vec2(
+            static_cast<float>(this->width) / static_cast<float>(this->capacityWidth),
+            static_cast<float>(this->height) / static_cast<float>(this->capacityHeight)
+        );
+    }
 }
\ No newline at end of file
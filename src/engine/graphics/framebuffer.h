@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "../graphics/texture.h"
+#include "../graphics/statecache.h"
 #include "../io/logger.h"
 
 #include <glm/glm.hpp>
@@ -17,16 +18,21 @@ namespace Brainstorm {
 
 		AttachmentType type;
 		GLint filter, clamp;
+		// Targets that are only sampled at their base level skip the mip chain, drop() does not regenerate it.
+		bool mipmaps;
 
-		Attachment(AttachmentType type, GLint filter, GLint clamp);
+		Attachment(AttachmentType type, GLint filter, GLint clamp, bool mipmaps = true);
 	};
 
+	// Attachments are allocated for the largest size requested so far. Shrinking only changes the region that
+	// is drawn into, sample it with getRegionScale() instead of the full [0, 1] range.
 	class FrameBuffer {
 	private:
 		std::vector<Attachment> attachments = {};
 
 		GLuint id, depthId;
 		GLsizei width, height;
+		GLsizei capacityWidth, capacityHeight;
 
 		inline void createAttachments();
 	public:
@@ -38,14 +44,19 @@ namespace Brainstorm {
 		void drop() const;
 		void drop(GLsizei previousWidth, GLsizei previousHeight) const;
 
-		void clear() const;
+		void clear();
+		// Reuses the attachments as long as they are big enough, reallocates only when growing past them.
 		void resize(GLsizei width, GLsizei height);
 
+		GLuint getId() const;
 		GLint getTexture(size_t attachment) const;
 
 		GLsizei getWidth() const;
 		GLsizei getHeight() const;
 
 		glm::vec2 getSize() const;
+		glm::ivec2 getCapacity() const;
+		// Texture coordinates of the far corner of the drawn region.
+		glm::vec2 getRegionScale() const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "gputimer.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace Brainstorm {
+	GpuTimer::GpuTimer() : written(0), read(0), active(false), milliseconds(0.0f), startTime(0) {
+		glGenQueries(static_cast<GLsizei>(this->queries.size()), this->queries.data());
+	}
+	GpuTimer::~GpuTimer() {
+		this->destroy();
+	}
+
+	void GpuTimer::begin() {
+		// Every query is still in flight, drop this sample rather than waiting for the GPU.
+		if (this->written - this->read >= Latency) return;
+
+		glQueryCounter(this->queries[(this->written % Latency) * 2], GL_TIMESTAMP);
+		this->active = true;
+	}
+	void GpuTimer::end() {
+		if (!this->active) return;
+
+		glQueryCounter(this->queries[(this->written % Latency) * 2 + 1], GL_TIMESTAMP);
+		this->active = false;
+		this->written++;
+	}
+
+	bool GpuTimer::poll() {
+		if (this->read == this->written) return false;
+
+		GLuint start = this->queries[(this->read % Latency) * 2];
+		GLuint end = this->queries[(this->read % Latency) * 2 + 1];
+
+		// The end timestamp is written last, once it is there both are.
+		GLint available = 0;
+		glGetQueryObjectiv(end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available) return false;
+
+		GLuint64 startTime = 0, endTime = 0;
+		glGetQueryObjectui64v(start, GL_QUERY_RESULT, &startTime);
+		glGetQueryObjectui64v(end, GL_QUERY_RESULT, &endTime);
+
+		GLuint64 elapsed = endTime > startTime ? endTime - startTime : 0;
+
+		this->milliseconds = static_cast<float>(static_cast<double>(elapsed) / 1000000.0);
+		this->startTime = static_cast<int64_t>(startTime);
+
+		this->read++;
+		return true;
+	}
+
+	float GpuTimer::getMilliseconds() const {
+		return this->milliseconds;
+	}
+	int64_t GpuTimer::getStartTime() const {
+		return this->startTime;
+	}
+
+	void GpuTimer::destroy() {
+		if (this->queries[0] == 0) return;
+
+		glDeleteQueries(static_cast<GLsizei>(this->queries.size()), this->queries.data());
+		this->queries = {};
+	}
+
+#ifdef BRAINSTORM_PROFILE
+	// Keyed by the name pointer, zone names are string literals.
+	static std::unordered_map<const char*, std::unique_ptr<GpuTimer>> timers;
+
+	uint32_t GpuProfiler::timeline = 0;
+
+	GpuTimer& GpuProfiler::getTimer(const char* name) {
+		std::unique_ptr<GpuTimer>& timer = timers[name];
+		if (timer == nullptr) {
+			timer = std::make_unique<GpuTimer>();
+		}
+
+		return *timer;
+	}
+
+	void GpuProfiler::collect() {
+		if (GpuProfiler::timeline == 0) {
+			GpuProfiler::timeline = Profiler::createTimeline("GPU");
+		}
+
+		// Zones start at their GPU timestamp, moved onto the CPU clock. GL_TIMESTAMP is read without waiting
+		// for the GPU, the offset is off by at most the command submission latency and follows clock drift.
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		int64_t clockOffset = Profiler::now() - static_cast<int64_t>(gpuNow);
+
+		for (auto& [name, timer] : timers) {
+			while (timer->poll()) {
+				Profiler::record(name, timer->getStartTime() + clockOffset, static_cast<int64_t>(timer->getMilliseconds() * 1000000.0f), GpuProfiler::timeline);
+			}
+		}
+	}
+	void GpuProfiler::destroy() {
+		timers.clear();
+	}
+
+	GpuProfileScope::GpuProfileScope(const char* name) : timer(GpuProfiler::getTimer(name)) {
+		this->timer.begin();
+	}
+	GpuProfileScope::~GpuProfileScope() {
+		this->timer.end();
+	}
+#endif
+}
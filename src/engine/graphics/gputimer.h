@@ -0,0 +1,70 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+
+#include "../util/profiler.h"
+
+namespace Brainstorm {
+	// Ring of GL_TIMESTAMP query pairs. Results are read back a few frames later, once the GPU has them,
+	// so timing never stalls the pipeline. Unlike GL_TIME_ELAPSED, timers can nest and overlap.
+	class GpuTimer {
+	public:
+		static const size_t Latency = 4;
+	private:
+		std::array<GLuint, Latency * 2> queries;
+
+		uint64_t written, read;
+		bool active;
+
+		float milliseconds;
+		int64_t startTime;
+	public:
+		GpuTimer();
+		~GpuTimer();
+
+		void begin();
+		void end();
+
+		// Reads the oldest finished query pair, returns false once none is left. Several can be ready after
+		// a stall, poll until false to see every one of them.
+		bool poll();
+
+		float getMilliseconds() const;
+		// GPU clock in nanoseconds, as glGetInteger64v(GL_TIMESTAMP).
+		int64_t getStartTime() const;
+
+		void destroy();
+	};
+
+	// Per pass GPU zones for the profiler, recorded into a "GPU" timeline. Render thread only,
+	// defined with BRAINSTORM_PROFILE.
+	class GpuProfiler {
+	private:
+		static uint32_t timeline;
+	public:
+		static GpuTimer& getTimer(const char* name);
+
+		static void collect();
+		static void destroy();
+	};
+
+	class GpuProfileScope {
+	private:
+		GpuTimer& timer;
+	public:
+		GpuProfileScope(const char* name);
+		~GpuProfileScope();
+	};
+}
+
+#ifdef BRAINSTORM_PROFILE
+#define BS_PROFILE_GPU_SCOPE(name) ::Brainstorm::GpuProfileScope BS_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#define BS_PROFILE_GPU_COLLECT() ::Brainstorm::GpuProfiler::collect()
+#define BS_PROFILE_GPU_DESTROY() ::Brainstorm::GpuProfiler::destroy()
+#else
+#define BS_PROFILE_GPU_SCOPE(name) ((void)0)
+#define BS_PROFILE_GPU_COLLECT() ((void)0)
+#define BS_PROFILE_GPU_DESTROY() ((void)0)
+#endif
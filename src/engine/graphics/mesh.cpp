@@ -1,5 +1,7 @@
 #include "mesh.h"
+#include "../io/logger.h"
 #include <ctype.h>
+#include <algorithm>
 
 namespace Brainstorm {
 	const GLint Mesh::TRIANGLES = GL_TRIANGLES;
@@ -12,64 +14,252 @@ namespace Brainstorm {
 
 	const GLint Mesh::POINTS = GL_POINTS;
 
-	GLuint Mesh::boundId = 0;
+	VertexLayout::VertexLayout(GLuint divisor, GLenum usage) : stride(0), divisor(divisor), usage(usage) {}
 
-	VertexBuffer::VertexBuffer(const std::vector<float>& data, int dimensions) {
+	VertexLayout& VertexLayout::add(GLuint location, GLint components, AttributeType type, bool normalized) {
+		this->attributes.push_back({ location, components, type, normalized, false, static_cast<size_t>(this->stride) });
+		this->stride += static_cast<GLsizei>(components * VertexLayout::getTypeSize(type));
+
+		return *this;
+	}
+	VertexLayout& VertexLayout::addInteger(GLuint location, GLint components, AttributeType type) {
+		this->attributes.push_back({ location, components, type, false, true, static_cast<size_t>(this->stride) });
+		this->stride += static_cast<GLsizei>(components * VertexLayout::getTypeSize(type));
+
+		return *this;
+	}
+	VertexLayout& VertexLayout::pad(size_t bytes) {
+		this->stride += static_cast<GLsizei>(bytes);
+		return *this;
+	}
+
+	const std::vector<VertexAttribute>& VertexLayout::getAttributes() const {
+		return this->attributes;
+	}
+	GLsizei VertexLayout::getStride() const {
+		return this->stride;
+	}
+
+	GLuint VertexLayout::getDivisor() const {
+		return this->divisor;
+	}
+	GLenum VertexLayout::getUsage() const {
+		return this->usage;
+	}
+
+	size_t VertexLayout::getTypeSize(AttributeType type) {
+		switch (type) {
+		case AttributeType::BYTE:
+		case AttributeType::UNSIGNED_BYTE:
+			return 1;
+		case AttributeType::HALF_FLOAT:
+		case AttributeType::SHORT:
+		case AttributeType::UNSIGNED_SHORT:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+
+	VertexBuffer::VertexBuffer(const std::vector<float>& data, int dimensions, GLuint divisor) {
 		this->data = data;
 		this->dimensions = dimensions;
+		this->divisor = divisor;
 	}
 
-	inline static GLuint createVertexBuffer(const VertexBuffer& vertices, GLuint index) {
+	inline static GLuint createVertexBuffer(const VertexStream& stream) {
 		GLuint id;
 		glGenBuffers(1, &id);
 		glBindBuffer(GL_ARRAY_BUFFER, id);
 
-		glBufferData(GL_ARRAY_BUFFER, vertices.data.size() * sizeof(float), vertices.data.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(stream.size), stream.data, stream.layout.getUsage());
 
-		glEnableVertexAttribArray(index);
-		glVertexAttribPointer(index, vertices.dimensions, GL_FLOAT, false, 0, nullptr);
+		const VertexLayout& layout = stream.layout;
+		for (const VertexAttribute& attribute : layout.getAttributes()) {
+			const void* offset = reinterpret_cast<const void*>(attribute.offset);
+
+			glEnableVertexAttribArray(attribute.location);
+			if (attribute.integer) {
+				glVertexAttribIPointer(attribute.location, attribute.components, static_cast<GLenum>(attribute.type), layout.getStride(), offset);
+			} else {
+				glVertexAttribPointer(attribute.location, attribute.components, static_cast<GLenum>(attribute.type), attribute.normalized, layout.getStride(), offset);
+			}
+			glVertexAttribDivisor(attribute.location, layout.getDivisor());
+		}
 
 		return id;
 	}
 
-	Mesh::Mesh(const VertexBuffer& vertices, const std::vector<VertexBuffer>& additional, GLint renderMode) {
+	Mesh::Mesh(const std::vector<VertexStream>& streams, GLint renderMode, const std::vector<uint32_t>& indices) {
 		this->id = 0;
-		this->buffers = std::vector<GLuint>(additional.size() + 1);
+		this->indexBuffer = 0;
 
-		this->vertexCount = static_cast<GLsizei>(vertices.data.size() / vertices.dimensions);
+		this->vertexCount = 0;
+		this->indexCount = 0;
+		this->indexType = GL_UNSIGNED_SHORT;
 		this->renderMode = renderMode;
 
 		glGenVertexArrays(1, &this->id);
-		glBindVertexArray(this->id);
+		GLStateCache::bindVertexArray(this->id);
+
+		bool counted = false;
+		for (const VertexStream& stream : streams) {
+			this->buffers.push_back(createVertexBuffer(stream));
+			this->capacities.push_back(stream.size);
+			this->usages.push_back(stream.layout.getUsage());
+
+			if (!counted && stream.layout.getDivisor() == 0 && stream.layout.getStride() > 0) {
+				this->vertexCount = static_cast<GLsizei>(stream.size / stream.layout.getStride());
+				counted = true;
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-		this->buffers[0] = createVertexBuffer(vertices, 0);
-		for (size_t i = 1; i < this->buffers.size(); i++) {
-			this->buffers[i] = createVertexBuffer(additional[i - 1], static_cast<GLuint>(i));
+		if (!indices.empty()) {
+			this->setIndices(indices);
 		}
 
-		glBindVertexArray(0);
+		GLStateCache::bindVertexArray(0);
 	}
+	Mesh::Mesh(const VertexBuffer& vertices, const std::vector<VertexBuffer>& additional, GLint renderMode)
+			: Mesh([&]() {
+				std::vector<VertexStream> streams;
+
+				streams.push_back({ VertexLayout(vertices.divisor).add(0, vertices.dimensions), vertices.data.data(), vertices.data.size() * sizeof(float) });
+				for (size_t i = 0; i < additional.size(); i++) {
+					const VertexBuffer& buffer = additional[i];
+					streams.push_back({ VertexLayout(buffer.divisor, GL_STREAM_DRAW).add(static_cast<GLuint>(i + 1), buffer.dimensions), buffer.data.data(), buffer.data.size() * sizeof(float) });
+				}
+
+				return streams;
+			}(), renderMode) {}
 	Mesh::~Mesh() {
 		this->destroy();
 	}
 	
 	void Mesh::render() const {
-		if (Mesh::boundId != this->id) {
-			glBindVertexArray(this->id);
-			Mesh::boundId = this->id;
+		GLStateCache::bindVertexArray(this->id);
+
+		if (this->indexBuffer != 0) {
+			glDrawElements(this->renderMode, this->indexCount, this->indexType, nullptr);
+		} else {
+			glDrawArrays(this->renderMode, 0, this->vertexCount);
 		}
+	}
+	void Mesh::render(GLsizei instances) const {
+		GLStateCache::bindVertexArray(this->id);
 
-		glDrawArrays(this->renderMode, 0, this->vertexCount);
+		if (this->indexBuffer != 0) {
+			glDrawElementsInstanced(this->renderMode, this->indexCount, this->indexType, nullptr, instances);
+		} else {
+			glDrawArraysInstanced(this->renderMode, 0, this->vertexCount, instances);
+		}
 	}
+
+	void Mesh::reserve(size_t buffer, size_t size) {
+		// Grow by half again so streams that creep up in size do not reallocate every frame.
+		size_t capacity = size > this->capacities[buffer] ? std::max(size, this->capacities[buffer] + this->capacities[buffer] / 2) : this->capacities[buffer];
+
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, this->usages[buffer]);
+		this->capacities[buffer] = capacity;
+	}
+
+	void Mesh::update(size_t buffer, const void* data, size_t size) {
+		if (buffer >= this->buffers.size()) {
+			Logger::error("Mesh buffer index out of bounds! 0 (inclusive) - %zu (exclusive).", this->buffers.size());
+			return;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers[buffer]);
+		this->reserve(buffer, size);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	void Mesh::update(size_t buffer, const std::vector<float>& data) {
+		this->update(buffer, data.data(), data.size() * sizeof(float));
+	}
+	void Mesh::update(size_t buffer, size_t offset, const void* data, size_t size) {
+		if (buffer >= this->buffers.size()) {
+			Logger::error("Mesh buffer index out of bounds! 0 (inclusive) - %zu (exclusive).", this->buffers.size());
+			return;
+		}
+		if (offset + size > this->capacities[buffer]) {
+			Logger::error("Mesh buffer update of %zu bytes at %zu exceeds its %zu bytes.", size, offset, this->capacities[buffer]);
+			return;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers[buffer]);
+		glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void* Mesh::map(size_t buffer, size_t size) {
+		if (buffer >= this->buffers.size()) {
+			Logger::error("Mesh buffer index out of bounds! 0 (inclusive) - %zu (exclusive).", this->buffers.size());
+			return nullptr;
+		}
+		if (size == 0) return nullptr;
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers[buffer]);
+		this->reserve(buffer, size);
+
+		return glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	}
+	void Mesh::unmap(size_t buffer) {
+		if (buffer >= this->buffers.size()) return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers[buffer]);
+		if (!glUnmapBuffer(GL_ARRAY_BUFFER)) {
+			Logger::warn("Mesh buffer %zu was corrupted while mapped.", buffer);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void Mesh::setIndices(const std::vector<uint32_t>& indices) {
+		// The element buffer binding belongs to the vertex array.
+		GLStateCache::bindVertexArray(this->id);
+
+		if (this->indexBuffer == 0) {
+			glGenBuffers(1, &this->indexBuffer);
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+
+		uint32_t maximum = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+
+		if (maximum <= UINT16_MAX) {
+			std::vector<uint16_t> packed(indices.begin(), indices.end());
+
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size() * sizeof(uint16_t)), packed.data(), GL_STATIC_DRAW);
+			this->indexType = GL_UNSIGNED_SHORT;
+		} else {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
+			this->indexType = GL_UNSIGNED_INT;
+		}
+
+		this->indexCount = static_cast<GLsizei>(indices.size());
+	}
+	void Mesh::setVertexCount(GLsizei vertexCount) {
+		this->vertexCount = vertexCount;
+	}
+
 	void Mesh::destroy() {
+		GLStateCache::forgetVertexArray(this->id);
 		glDeleteVertexArrays(1, &this->id);
 		for (GLuint buffer : this->buffers) {
 			glDeleteBuffers(1, &buffer);
 		}
+		if (this->indexBuffer != 0) {
+			glDeleteBuffers(1, &this->indexBuffer);
+		}
+
+		this->id = 0;
+		this->indexBuffer = 0;
+		this->buffers.clear();
+		this->capacities.clear();
+		this->usages.clear();
 	}
 	
 	void Mesh::drop() {
-		Mesh::boundId = 0;
-		glBindVertexArray(0);
+		GLStateCache::bindVertexArray(0);
 	}
-}
\ No newline at end of file
+}
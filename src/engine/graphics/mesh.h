@@ -1,24 +1,83 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <stdint.h>
 #include <glad/glad.h>
 
+#include "statecache.h"
+
 namespace Brainstorm {
+	enum class AttributeType : GLenum {
+		FLOAT = GL_FLOAT, HALF_FLOAT = GL_HALF_FLOAT,
+		BYTE = GL_BYTE, UNSIGNED_BYTE = GL_UNSIGNED_BYTE,
+		SHORT = GL_SHORT, UNSIGNED_SHORT = GL_UNSIGNED_SHORT,
+		INT = GL_INT, UNSIGNED_INT = GL_UNSIGNED_INT
+	};
+
+	struct VertexAttribute {
+		GLuint location;
+		GLint components;
+		AttributeType type;
+
+		bool normalized; // Integer types read as 0..1 or -1..1 floats
+		bool integer; // Read as ints in the shader, glVertexAttribIPointer
+
+		size_t offset;
+	};
+
+	// Attributes interleaved in one buffer, in the order they are added.
+	class VertexLayout {
+	private:
+		std::vector<VertexAttribute> attributes;
+		GLsizei stride;
+
+		GLuint divisor;
+		GLenum usage;
+	public:
+		// Divisor 1 advances once per instance. Usage is the hint for the initial data and every update.
+		VertexLayout(GLuint divisor = 0, GLenum usage = GL_STATIC_DRAW);
+
+		VertexLayout& add(GLuint location, GLint components, AttributeType type = AttributeType::FLOAT, bool normalized = false);
+		VertexLayout& addInteger(GLuint location, GLint components, AttributeType type);
+		VertexLayout& pad(size_t bytes);
+
+		const std::vector<VertexAttribute>& getAttributes() const;
+		GLsizei getStride() const;
+
+		GLuint getDivisor() const;
+		GLenum getUsage() const;
+
+		static size_t getTypeSize(AttributeType type);
+	};
+
+	struct VertexStream {
+		VertexLayout layout;
+
+		const void* data = nullptr; // May be empty for buffers filled by update() or map()
+		size_t size = 0; // In bytes
+	};
+
 	struct VertexBuffer {
 		std::vector<float> data;
 		int dimensions;
+		GLuint divisor;
 
-		VertexBuffer(const std::vector<float>& data, int dimensions);
+		VertexBuffer(const std::vector<float>& data, int dimensions, GLuint divisor = 0);
 	};
 
 	class Mesh {
 	private:
-		GLuint id;
-		static GLuint boundId;
+		GLuint id, indexBuffer;
 
 		std::vector<GLuint> buffers;
+		std::vector<size_t> capacities;
+		std::vector<GLenum> usages;
 
-		GLsizei vertexCount;
+		GLsizei vertexCount, indexCount;
+		GLenum indexType;
 		GLint renderMode;
+
+		inline void reserve(size_t buffer, size_t size);
 	public:
 		const static GLint TRIANGLES;
 		const static GLint TRIANGLE_FAN;
@@ -30,12 +89,31 @@ namespace Brainstorm {
 
 		const static GLint POINTS;
 
+		// The vertex count comes from the first per-vertex stream. Indices are stored as 16 bit when they fit.
+		Mesh(const std::vector<VertexStream>& streams, GLint renderMode, const std::vector<uint32_t>& indices = {});
+		// One float buffer per attribute, at locations 0, 1, 2...
 		Mesh(const VertexBuffer& vertices, const std::vector<VertexBuffer>& additional, GLint renderMode);
 		~Mesh();
 
 		void render() const;
+		void render(GLsizei instances) const;
+
+		// Replaces the contents of a buffer. Storage only grows, and is orphaned otherwise, so the GPU can
+		// keep reading the previous contents without a stall.
+		void update(size_t buffer, const void* data, size_t size);
+		void update(size_t buffer, const std::vector<float>& data);
+		// Overwrites part of the current contents, the range has to fit in what the buffer already holds.
+		void update(size_t buffer, size_t offset, const void* data, size_t size);
+
+		// Write only mapping of the first size bytes, the previous contents are discarded.
+		void* map(size_t buffer, size_t size);
+		void unmap(size_t buffer);
+
+		void setIndices(const std::vector<uint32_t>& indices);
+		void setVertexCount(GLsizei vertexCount);
+
 		void destroy();
 
 		static void drop();
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,143 @@
+#include "particles.h"
+#include "statecache.h"
+
+namespace Brainstorm {
+	ParticleSystem::ParticleSystem(uint32_t capacity, const char* simulationVertex, const char* simulationGeometry)
+			: simulation(simulationVertex, nullptr, simulationGeometry, { "outPosition", "outVelocity", "outColor", "outState" }),
+			emitterCapacity(0), capacity(capacity), current(0), simulated(false), seed(1) {
+		glGenBuffers(2, this->buffers.data());
+		glGenTransformFeedbacks(2, this->feedbacks.data());
+		glGenVertexArrays(2, this->vertexArrays.data());
+
+		for (size_t i = 0; i < 2; i++) {
+			GLStateCache::bindVertexArray(this->vertexArrays[i]);
+
+			glBindBuffer(GL_ARRAY_BUFFER, this->buffers[i]);
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity) * ParticleFloats * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+
+			ParticleSystem::setAttributes();
+
+			// The output binding is part of the feedback object, it never changes afterwards.
+			glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, this->feedbacks[i]);
+			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->buffers[i]);
+		}
+
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+
+		glGenBuffers(1, &this->emitterBuffer);
+		glGenVertexArrays(1, &this->emitterArray);
+
+		GLStateCache::bindVertexArray(this->emitterArray);
+		glBindBuffer(GL_ARRAY_BUFFER, this->emitterBuffer);
+		ParticleSystem::setAttributes();
+
+		GLStateCache::bindVertexArray(0);
+	}
+	ParticleSystem::~ParticleSystem() {
+		this->destroy();
+	}
+
+	void ParticleSystem::setAttributes() {
+		const GLsizei Stride = ParticleFloats * sizeof(float);
+		const std::array<GLint, 4> Components = { 2, 2, 4, 4 };
+
+		size_t offset = 0;
+		for (GLuint location = 0; location < Components.size(); location++) {
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, Components[location], GL_FLOAT, GL_FALSE, Stride, reinterpret_cast<const void*>(offset * sizeof(float)));
+
+			offset += Components[location];
+		}
+	}
+
+	void ParticleSystem::emit(const ParticleBurst& burst) {
+		// Split into emitter points the geometry shader can expand in one invocation.
+		for (uint32_t spawned = 0; spawned < burst.count; spawned += MaxBurst) {
+			uint32_t count = burst.count - spawned < MaxBurst ? burst.count - spawned : MaxBurst;
+
+			this->emitters.insert(this->emitters.end(), {
+				burst.position.x, burst.position.y, burst.velocity.x, burst.velocity.y,
+				burst.color.x, burst.color.y, burst.color.z, burst.color.w,
+				burst.speed, burst.lifetime, burst.size, static_cast<float>(count)
+			});
+		}
+	}
+
+	void ParticleSystem::update(float delta, float drag) {
+		GLsizei emitterCount = static_cast<GLsizei>(this->emitters.size() / ParticleFloats);
+
+		// Nothing was ever spawned, nothing can be alive.
+		if (!this->simulated && emitterCount == 0) return;
+
+		if (emitterCount > 0) {
+			size_t size = this->emitters.size() * sizeof(float);
+
+			// Orphaned every frame, the previous emitters may still be read by the GPU.
+			glBindBuffer(GL_ARRAY_BUFFER, this->emitterBuffer);
+			this->emitterCapacity = size > this->emitterCapacity ? size : this->emitterCapacity;
+
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(this->emitterCapacity), nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), this->emitters.data());
+		}
+
+		size_t next = 1 - this->current;
+
+		this->simulation.use();
+		this->simulation.setFloat("delta", delta);
+		this->simulation.setFloat("drag", drag);
+		this->simulation.setInt("seed", static_cast<int>(this->seed++));
+
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, this->feedbacks[next]);
+		glBeginTransformFeedback(GL_POINTS);
+
+		// Survivors first, then the new particles, both appended to the other buffer.
+		if (this->simulated) {
+			GLStateCache::bindVertexArray(this->vertexArrays[this->current]);
+			glDrawTransformFeedback(GL_POINTS, this->feedbacks[this->current]);
+		}
+		if (emitterCount > 0) {
+			GLStateCache::bindVertexArray(this->emitterArray);
+			glDrawArrays(GL_POINTS, 0, emitterCount);
+		}
+
+		glEndTransformFeedback();
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+
+		this->current = next;
+		this->simulated = true;
+		this->emitters.clear();
+	}
+
+	void ParticleSystem::render() const {
+		if (!this->simulated) return;
+
+		GLStateCache::bindVertexArray(this->vertexArrays[this->current]);
+		glDrawTransformFeedback(GL_POINTS, this->feedbacks[this->current]);
+	}
+
+	uint32_t ParticleSystem::getCapacity() const {
+		return this->capacity;
+	}
+
+	void ParticleSystem::destroy() {
+		if (this->buffers[0] == 0) return;
+
+		for (GLuint vertexArray : this->vertexArrays) {
+			GLStateCache::forgetVertexArray(vertexArray);
+		}
+		GLStateCache::forgetVertexArray(this->emitterArray);
+
+		glDeleteVertexArrays(2, this->vertexArrays.data());
+		glDeleteVertexArrays(1, &this->emitterArray);
+		glDeleteTransformFeedbacks(2, this->feedbacks.data());
+		glDeleteBuffers(2, this->buffers.data());
+		glDeleteBuffers(1, &this->emitterBuffer);
+
+		this->simulation.destroy();
+
+		this->buffers = {};
+		this->emitterBuffer = 0;
+	}
+}
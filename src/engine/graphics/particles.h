@@ -0,0 +1,66 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "shader.h"
+
+namespace Brainstorm {
+	// Particles spawned around one point, spread in random directions.
+	struct ParticleBurst {
+		glm::vec2 position;
+		glm::vec2 velocity; // Inherited by every particle
+		glm::vec4 color;
+
+		float speed; // Of the random spread
+		float lifetime; // In seconds
+		float size; // In world units
+		uint32_t count;
+	};
+
+	// Particles simulated with transform feedback, ping-ponged between two buffers. The CPU only uploads the
+	// bursts of a frame as emitter points, live particles never leave the GPU and their count is never read back.
+	//
+	// Both emitters and particles are points of ParticleFloats: position.xy, velocity.xy, color.rgba and a state.
+	// An emitter's state is (speed, lifetime, size, count), a particle's is (age, lifetime, size, 0).
+	class ParticleSystem {
+	public:
+		// Particles one emitter point can spawn, the output limit of the simulation geometry shader.
+		static const uint32_t MaxBurst = 64;
+		static const uint32_t ParticleFloats = 12;
+	private:
+		ShaderProgram simulation;
+
+		std::array<GLuint, 2> buffers, feedbacks, vertexArrays;
+		GLuint emitterBuffer, emitterArray;
+		size_t emitterCapacity;
+
+		uint32_t capacity;
+		size_t current; // Index of the buffer holding the live particles
+		bool simulated; // False until the first update, there is no feedback to draw from before
+		uint32_t seed;
+
+		std::vector<float> emitters;
+
+		static void setAttributes();
+	public:
+		// The simulation shaders write outPosition, outVelocity, outColor and outState. Spawns beyond the capacity are dropped.
+		ParticleSystem(uint32_t capacity, const char* simulationVertex, const char* simulationGeometry);
+		~ParticleSystem();
+
+		void emit(const ParticleBurst& burst);
+
+		// Spawns the bursts emitted since the last update and advances every live particle.
+		void update(float delta, float drag);
+		// Draws the live particles as points with the bound program, attributes at locations 0 to 3.
+		void render() const;
+
+		uint32_t getCapacity() const;
+
+		void destroy();
+	};
+}
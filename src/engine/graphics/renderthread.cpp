@@ -0,0 +1,201 @@
+#include "renderthread.h"
+#include "../io/window.h"
+#include "../io/logger.h"
+#include "../util/profiler.h"
+
+#include <fstream>
+
+namespace Brainstorm {
+	void FramePacket::clear() {
+		this->commands.clear();
+		this->instances.clear();
+	}
+	void FramePacket::draw(uint16_t pass, uint32_t offset, uint32_t count) {
+		this->commands.push_back({ pass, offset, count });
+	}
+
+	static const uint32_t PacketMagic = 0x50465342; // "BSFP"
+	static const uint32_t PacketVersion = 1;
+
+	template<typename T>
+	inline static void write(std::ofstream& file, const T& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+	template<typename T>
+	inline static void read(std::ifstream& file, T& value) {
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+	}
+
+	bool FramePacket::save(const char* location) const {
+		std::ofstream file(location, std::ios::binary);
+
+		if (!file.is_open()) {
+			Logger::error("Could not open \"%s\" to record the frame.", location);
+			return false;
+		}
+
+		write(file, PacketMagic);
+		write(file, PacketVersion);
+
+		write(file, this->view.cameraPosition.x);
+		write(file, this->view.cameraPosition.y);
+		write(file, this->view.zoom);
+		write(file, this->view.aspect);
+		write(file, this->view.framebufferSize.x);
+		write(file, this->view.framebufferSize.y);
+
+		write(file, static_cast<uint32_t>(this->commands.size()));
+		for (const DrawCommand& command : this->commands) {
+			write(file, command.pass);
+			write(file, command.offset);
+			write(file, command.count);
+		}
+
+		write(file, static_cast<uint32_t>(this->instances.size()));
+		file.write(reinterpret_cast<const char*>(this->instances.data()), this->instances.size() * sizeof(float));
+
+		return file.good();
+	}
+	bool FramePacket::load(const char* location) {
+		std::ifstream file(location, std::ios::binary);
+
+		if (!file.is_open()) {
+			Logger::error("Could not open recorded frame \"%s\".", location);
+			return false;
+		}
+
+		uint32_t magic = 0, version = 0;
+		read(file, magic);
+		read(file, version);
+
+		if (magic != PacketMagic || version != PacketVersion) {
+			Logger::error("\"%s\" is not a recorded frame of this version.", location);
+			return false;
+		}
+
+		this->clear();
+
+		read(file, this->view.cameraPosition.x);
+		read(file, this->view.cameraPosition.y);
+		read(file, this->view.zoom);
+		read(file, this->view.aspect);
+		read(file, this->view.framebufferSize.x);
+		read(file, this->view.framebufferSize.y);
+
+		uint32_t count = 0;
+		read(file, count);
+
+		this->commands.resize(count);
+		for (DrawCommand& command : this->commands) {
+			read(file, command.pass);
+			read(file, command.offset);
+			read(file, command.count);
+		}
+
+		read(file, count);
+
+		this->instances.resize(count);
+		file.read(reinterpret_cast<char*>(this->instances.data()), static_cast<std::streamsize>(count) * sizeof(float));
+
+		if (!file) {
+			Logger::error("Recorded frame \"%s\" is truncated.", location);
+			this->clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	RenderThread::RenderThread() : recording(0), submitted(0), pending(false), busy(false), running(false), frame(0) {}
+	RenderThread::~RenderThread() {
+		this->stop();
+	}
+
+	void RenderThread::start(const RenderCallback& callback) {
+		if (this->running) {
+			Logger::error("RenderThread already started!");
+			return;
+		}
+
+		this->callback = callback;
+		this->running = true;
+
+		// The context can only be current on one thread at a time, hand it over to the backend.
+		Window::detachContext();
+		this->thread = std::thread(&RenderThread::run, this);
+	}
+	void RenderThread::stop() {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->running) return;
+
+			this->running = false;
+		}
+
+		this->condition.notify_all();
+		this->thread.join();
+
+		Window::attachContext();
+	}
+
+	void RenderThread::run() {
+		Window::attachContext();
+		BS_PROFILE_THREAD("Render");
+
+		while (true) {
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->condition.wait(lock, [this]() { return this->pending || !this->running; });
+
+				if (!this->pending) break;
+
+				index = this->submitted;
+				this->pending = false;
+				this->busy = true;
+			}
+
+			{
+				BS_PROFILE_SCOPE("Frame");
+				this->callback(this->packets[index]);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->busy = false;
+			}
+			this->condition.notify_all();
+		}
+
+		Window::detachContext();
+	}
+
+	FramePacket& RenderThread::begin() {
+		FramePacket& packet = this->packets[this->recording];
+		packet.clear();
+		packet.frame = this->frame;
+
+		return packet;
+	}
+	void RenderThread::submit() {
+		BS_PROFILE_SCOPE("Submit");
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			// The packet recorded next reuses the buffer the backend drew last, wait until it is done with it.
+			this->condition.wait(lock, [this]() { return (!this->pending && !this->busy) || !this->running; });
+			if (!this->running) return;
+
+			this->submitted = this->recording;
+			this->pending = true;
+		}
+		this->condition.notify_all();
+
+		this->recording = 1 - this->recording;
+		this->frame++;
+	}
+
+	bool RenderThread::isRunning() const {
+		return this->running;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Brainstorm {
+	struct DrawCommand {
+		uint16_t pass;
+		uint32_t offset; // Into FramePacket::instances, in floats
+		uint32_t count; // Instances
+	};
+
+	struct FrameView {
+		glm::vec2 cameraPosition = glm::vec2();
+		float zoom = 1.0f, aspect = 1.0f;
+
+		glm::ivec2 framebufferSize = glm::ivec2();
+	};
+
+	// Everything the backend needs to draw one frame. Recorded by the game thread, consumed by the render thread.
+	// The layout of the instance stream is defined by the pass each command refers to.
+	struct FramePacket {
+		uint64_t frame = 0;
+		FrameView view;
+
+		std::vector<DrawCommand> commands;
+		std::vector<float> instances;
+
+		void clear();
+		void draw(uint16_t pass, uint32_t offset, uint32_t count);
+
+		// Recorded scenes to replay a frame outside the game, in native byte order.
+		bool save(const char* location) const;
+		bool load(const char* location);
+	};
+
+	typedef std::function<void(const FramePacket& packet)> RenderCallback;
+
+	// Frontend/backend split: the game thread records packet N + 1 while the render thread, which owns the
+	// GL context, draws packet N. submit() only waits when the backend falls more than one frame behind.
+	class RenderThread {
+	private:
+		std::thread thread;
+
+		std::mutex mutex;
+		std::condition_variable condition;
+
+		std::array<FramePacket, 2> packets;
+		size_t recording, submitted;
+
+		bool pending, busy;
+		// Written under the mutex, atomic so isRunning() can read it from any thread without it.
+		std::atomic<bool> running;
+		uint64_t frame;
+
+		RenderCallback callback;
+
+		void run();
+	public:
+		RenderThread();
+		~RenderThread();
+
+		void start(const RenderCallback& callback);
+		void stop();
+
+		FramePacket& begin();
+		void submit();
+
+		bool isRunning() const;
+	};
+}
@@ -1,6 +1,11 @@
 #include "shader.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <random>
 #include <vector>
 
 #define LOG_PROGRAM_ERROR() const size_t errorLength = 500;\
@@ -8,10 +13,7 @@ char error[errorLength];\
 glGetProgramInfoLog(this->id, errorLength, nullptr, error);\
 Logger::error("Could not compile ShaderProgram. Error: %s\n", error)
 
-#define USE_PROGRAM() if (ShaderProgram::boundId != this->id) {\
-	glUseProgram(this->id);\
-	ShaderProgram::boundId = this->id;\
-}
+#define USE_PROGRAM() GLStateCache::useProgram(this->id)
 
 namespace Brainstorm {
 	inline static void logProgramError(GLuint programId) {
@@ -91,14 +93,7 @@ namespace Brainstorm {
 		file.close();
 		return true;
 	}
-	inline static GLuint setShader(GLuint programId, const char* location, unsigned int type) {
-		std::string source;
-		std::vector<std::filesystem::path> includePathes;
-		
-		if (!preprocessShader(location, source, includePathes, 0)) {
-			return 0;
-		}
-
+	inline static GLuint setShader(GLuint programId, const std::string& source, unsigned int type) {
 		GLuint shaderId = 0;
 		const char* code = source.c_str();
 
@@ -138,20 +133,178 @@ namespace Brainstorm {
 		return shaderId;
 	}
 
-	GLuint ShaderProgram::boundId = 0;
+	// FNV-1a, 64 bit.
+	inline static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+	inline static uint64_t hashString(uint64_t hash, const char* string) {
+		return string != nullptr ? hashBytes(hash, string, std::strlen(string) + 1) : hashBytes(hash, "", 1);
+	}
+
+	static const uint32_t BinaryMagic = 0x50425342; // "BSBP"
+	static const uint32_t BinaryVersion = 1;
+
+	std::string ShaderProgram::cacheDirectory = "./cache/shaders";
+
+	void ShaderProgram::setCacheDirectory(const char* directory) {
+		ShaderProgram::cacheDirectory = directory != nullptr ? directory : "";
+	}
+
+	bool ShaderProgram::loadBinary(const std::string& location) {
+		std::ifstream file(location, std::ios::binary);
+		if (!file.is_open()) return false;
+
+		uint32_t magic = 0, version = 0;
+		GLenum format = 0;
+
+		file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		file.read(reinterpret_cast<char*>(&format), sizeof(format));
+
+		if (!file || magic != BinaryMagic || version != BinaryVersion) return false;
+
+		std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		glProgramBinary(this->id, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+		GLint success;
+		glGetProgramiv(this->id, GL_LINK_STATUS, &success);
+
+		// Drivers may reject binaries of an older build even when the version string matched.
+		if (!success) {
+			Logger::warn("Program binary \"%s\" was rejected by the driver, compiling from source.", location.c_str());
+
+			glDeleteProgram(this->id);
+			this->id = glCreateProgram();
+
+			return false;
+		}
+
+		return true;
+	}
+	void ShaderProgram::saveBinary(const std::string& location) const {
+		GLint length = 0;
+		glGetProgramiv(this->id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+		if (length <= 0) return;
+
+		std::vector<char> binary(static_cast<size_t>(length));
+		GLenum format = 0;
+		glGetProgramBinary(this->id, length, &length, &format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(location).parent_path(), error);
+
+		// Written next to the binary and renamed over it once complete, so a crash or a second instance
+		// starting at the same time never leaves a truncated binary for the next launch to load.
+		static const uint32_t Instance = std::random_device()();
+		static std::atomic<uint32_t> writeCount = 0;
+		std::string temporary = location + "." + std::to_string(Instance) + "." + std::to_string(writeCount.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+		std::ofstream file(temporary, std::ios::binary);
+		if (!file.is_open()) {
+			Logger::warn("Could not write program binary \"%s\".", location.c_str());
+			return;
+		}
+
+		file.write(reinterpret_cast<const char*>(&BinaryMagic), sizeof(BinaryMagic));
+		file.write(reinterpret_cast<const char*>(&BinaryVersion), sizeof(BinaryVersion));
+		file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+		file.write(binary.data(), length);
+		file.close();
+
+		if (!file.good()) {
+			Logger::warn("Could not write program binary \"%s\".", location.c_str());
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+
+		std::filesystem::rename(temporary, location, error);
+		if (error) {
+			Logger::warn("Could not replace program binary \"%s\": %s", location.c_str(), error.message().c_str());
+			std::filesystem::remove(temporary, error);
+		}
+	}
 
 	void ShaderProgram::create() {
+		auto start = std::chrono::steady_clock::now();
+
 		this->id = glCreateProgram();
 		this->shaders = std::array<unsigned int, 3>();
 
-		if (this->vertexLocation != nullptr) {
-			this->shaders[0] = setShader(this->id, vertexLocation, GL_VERTEX_SHADER);
+		const std::array<const char*, 3> locations = { this->vertexLocation, this->fragmentLocation, this->geometryLocation };
+		const std::array<GLenum, 3> types = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+
+		std::array<std::string, 3> sources;
+		bool preprocessed = true;
+
+		// The key covers everything the driver compiles, so any edit to a shader or one of its includes misses.
+		uint64_t key = 0xCBF29CE484222325ull;
+
+		for (size_t i = 0; i < locations.size(); i++) {
+			if (locations[i] == nullptr) continue;
+
+			std::vector<std::filesystem::path> includePathes;
+			if (!preprocessShader(locations[i], sources[i], includePathes, 0)) {
+				preprocessed = false;
+				continue;
+			}
+
+			key = hashBytes(key, &types[i], sizeof(GLenum));
+			key = hashString(key, sources[i].c_str());
 		}
-		if (this->fragmentLocation != nullptr) {
-			this->shaders[1] = setShader(this->id, fragmentLocation, GL_FRAGMENT_SHADER);
+
+		// Captured varyings are part of the linked binary.
+		for (const std::string& varying : this->feedbackVaryings) {
+			key = hashString(key, varying.c_str());
 		}
-		if (this->geometryLocation != nullptr) {
-			this->shaders[2] = setShader(this->id, geometryLocation, GL_GEOMETRY_SHADER);
+
+		key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+		key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+		key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+		GLint binaryFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+
+		std::string binaryLocation;
+		if (preprocessed && binaryFormats > 0 && !ShaderProgram::cacheDirectory.empty()) {
+			char name[32];
+			std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+
+			binaryLocation = (std::filesystem::path(ShaderProgram::cacheDirectory) / name).string();
+		}
+
+		const char* name = this->vertexLocation != nullptr ? this->vertexLocation : this->fragmentLocation;
+
+		if (!binaryLocation.empty() && this->loadBinary(binaryLocation)) {
+			float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			Logger::info("ShaderProgram \"%s\" loaded from the binary cache in %.2f ms.", name, milliseconds);
+
+			return;
+		}
+
+		if (!binaryLocation.empty()) {
+			glProgramParameteri(this->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		for (size_t i = 0; i < locations.size(); i++) {
+			if (locations[i] == nullptr || sources[i].empty()) continue;
+			this->shaders[i] = setShader(this->id, sources[i], types[i]);
+		}
+
+		if (!this->feedbackVaryings.empty()) {
+			std::vector<const char*> varyings;
+			for (const std::string& varying : this->feedbackVaryings) {
+				varyings.push_back(varying.c_str());
+			}
+
+			glTransformFeedbackVaryings(this->id, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
 		}
 
 		glLinkProgram(this->id);
@@ -164,6 +317,13 @@ namespace Brainstorm {
 			return;
 		}
 
+		if (!binaryLocation.empty()) {
+			this->saveBinary(binaryLocation);
+		}
+
+		float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		Logger::info("ShaderProgram \"%s\" compiled from source in %.2f ms.", name, milliseconds);
+
 		glValidateProgram(this->id);
 		glGetProgramiv(this->id, GL_VALIDATE_STATUS, &success);
 
@@ -176,6 +336,10 @@ namespace Brainstorm {
 			: vertexLocation(vertexLocation), fragmentLocation(fragmentLocation), geometryLocation(geometryLocation) {
 		this->create();
 	}
+	ShaderProgram::ShaderProgram(const char* vertexLocation, const char* fragmentLocation, const char* geometryLocation, const std::vector<std::string>& feedbackVaryings)
+			: vertexLocation(vertexLocation), fragmentLocation(fragmentLocation), geometryLocation(geometryLocation), feedbackVaryings(feedbackVaryings) {
+		this->create();
+	}
 	ShaderProgram::~ShaderProgram() {
 		this->destroy();
 	}
@@ -184,20 +348,24 @@ namespace Brainstorm {
 		USE_PROGRAM();
 	}
 	void ShaderProgram::drop() {
-		ShaderProgram::boundId = 0;
-		glUseProgram(0);
+		GLStateCache::useProgram(0);
 	}
 	void ShaderProgram::reload() {
 		this->destroy();
 		this->create();
 	}
 
-	void ShaderProgram::destroy() const {
-		glDetachShader(this->id, this->shaders[0]);
-		glDetachShader(this->id, this->shaders[1]);
-		glDetachShader(this->id, this->shaders[2]);
+	void ShaderProgram::destroy() {
+		// Programs loaded from a binary never had shaders attached.
+		for (GLuint shader : this->shaders) {
+			if (shader != 0) glDetachShader(this->id, shader);
+		}
 
+		GLStateCache::forgetProgram(this->id);
 		glDeleteProgram(this->id);
+
+		this->id = 0;
+		this->shaders = {};
 	}
 
 	void ShaderProgram::setBool(const char* location, bool value) const {
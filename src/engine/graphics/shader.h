@@ -6,29 +6,45 @@
 #include <sstream>
 #include <array>
 #include <algorithm>
+#include <string>
+#include <vector>
 
+#include "statecache.h"
 #include "../io/logger.h"
 
 namespace Brainstorm {
 	class ShaderProgram {
 	private:
 		GLuint id;
-		static GLuint boundId;
 
 		std::array<GLuint, 3> shaders;
 
 		const char *vertexLocation, *fragmentLocation, *geometryLocation;
+
+		// Outputs of the last vertex stage captured by transform feedback, interleaved in this order.
+		std::vector<std::string> feedbackVaryings;
+
+		static std::string cacheDirectory;
+
 		inline void create();
+		inline bool loadBinary(const std::string& location);
+		inline void saveBinary(const std::string& location) const;
 	public:
 		ShaderProgram(const char* vertexLocation, const char* fragmentLocation, const char* geometryLocation);
+		// Transform feedback program, the fragment shader may be null when rasterization is discarded.
+		ShaderProgram(const char* vertexLocation, const char* fragmentLocation, const char* geometryLocation, const std::vector<std::string>& feedbackVaryings);
 		~ShaderProgram();
 		
 		void use() const;
-		void destroy() const;
+		void destroy();
 		void reload();
 		
 		static void drop();
 
+		// Linked programs are cached as driver binaries, keyed by their preprocessed sources and the driver.
+		// An empty directory disables the cache.
+		static void setCacheDirectory(const char* directory);
+
 		void setBool(const char* location, bool value) const;
 		void setInt(const char* location, int value) const;
 		void setFloat(const char* location, float value) const;
@@ -0,0 +1,167 @@
+#include "statecache.h"
+#include "../io/logger.h"
+
+namespace Brainstorm {
+	const GLuint GLStateCache::Unknown = ~0u;
+
+	GLuint GLStateCache::program = GLStateCache::Unknown;
+	GLuint GLStateCache::vertexArray = GLStateCache::Unknown;
+	GLuint GLStateCache::framebuffer = GLStateCache::Unknown;
+
+	GLint GLStateCache::activeTexture = -1;
+	std::array<GLuint, GLStateCache::TextureUnits> GLStateCache::textures = {};
+	std::array<GLenum, GLStateCache::TextureUnits> GLStateCache::textureTargets = {};
+
+	int GLStateCache::blend = -1, GLStateCache::depthTest = -1;
+	GLenum GLStateCache::blendSource = GLStateCache::Unknown, GLStateCache::blendDestination = GLStateCache::Unknown;
+
+	std::array<GLint, 4> GLStateCache::viewport = { -1, -1, -1, -1 };
+
+	GLStateStats GLStateCache::stats = {};
+
+	uint64_t GLStateStats::getIssued() const {
+		uint64_t total = 0;
+		for (uint64_t count : this->issued) total += count;
+
+		return total;
+	}
+	uint64_t GLStateStats::getSkipped() const {
+		uint64_t total = 0;
+		for (uint64_t count : this->skipped) total += count;
+
+		return total;
+	}
+
+	bool GLStateCache::record(GLStateType type, bool redundant) {
+		if (redundant) {
+			GLStateCache::stats.skipped[static_cast<size_t>(type)]++;
+		} else {
+			GLStateCache::stats.issued[static_cast<size_t>(type)]++;
+		}
+
+		return redundant;
+	}
+
+	void GLStateCache::useProgram(GLuint program) {
+		if (GLStateCache::record(GLStateType::PROGRAM, GLStateCache::program == program)) return;
+
+		glUseProgram(program);
+		GLStateCache::program = program;
+	}
+	void GLStateCache::bindVertexArray(GLuint vertexArray) {
+		if (GLStateCache::record(GLStateType::VERTEX_ARRAY, GLStateCache::vertexArray == vertexArray)) return;
+
+		glBindVertexArray(vertexArray);
+		GLStateCache::vertexArray = vertexArray;
+	}
+	void GLStateCache::bindFramebuffer(GLuint framebuffer) {
+		if (GLStateCache::record(GLStateType::FRAMEBUFFER, GLStateCache::framebuffer == framebuffer)) return;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		GLStateCache::framebuffer = framebuffer;
+	}
+
+	void GLStateCache::setActiveTexture(GLint unit) {
+		if (GLStateCache::record(GLStateType::ACTIVE_TEXTURE, GLStateCache::activeTexture == unit)) return;
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		GLStateCache::activeTexture = unit;
+	}
+	void GLStateCache::bindTexture(GLenum target, GLuint texture) {
+		GLStateCache::bindTexture(target, texture, GLStateCache::activeTexture < 0 ? 0 : GLStateCache::activeTexture);
+	}
+	void GLStateCache::bindTexture(GLenum target, GLuint texture, GLint unit) {
+		if (unit < 0 || unit >= static_cast<GLint>(GLStateCache::TextureUnits)) {
+			Logger::error("Texture binding index out of bounds! 0 (inclusive) - %d (exclusive).", static_cast<int>(GLStateCache::TextureUnits));
+			return;
+		}
+
+		if (GLStateCache::record(GLStateType::TEXTURE, GLStateCache::textures[unit] == texture && GLStateCache::textureTargets[unit] == target)) return;
+
+		GLStateCache::setActiveTexture(unit);
+		glBindTexture(target, texture);
+
+		GLStateCache::textures[unit] = texture;
+		GLStateCache::textureTargets[unit] = target;
+	}
+
+	void GLStateCache::setBlend(bool enabled) {
+		if (GLStateCache::record(GLStateType::BLEND, GLStateCache::blend == static_cast<int>(enabled))) return;
+
+		if (enabled) {
+			glEnable(GL_BLEND);
+		} else {
+			glDisable(GL_BLEND);
+		}
+		GLStateCache::blend = static_cast<int>(enabled);
+	}
+	void GLStateCache::setBlendFunc(GLenum source, GLenum destination) {
+		if (GLStateCache::record(GLStateType::BLEND_FUNC, GLStateCache::blendSource == source && GLStateCache::blendDestination == destination)) return;
+
+		glBlendFunc(source, destination);
+		GLStateCache::blendSource = source;
+		GLStateCache::blendDestination = destination;
+	}
+	void GLStateCache::setDepthTest(bool enabled) {
+		if (GLStateCache::record(GLStateType::DEPTH_TEST, GLStateCache::depthTest == static_cast<int>(enabled))) return;
+
+		if (enabled) {
+			glEnable(GL_DEPTH_TEST);
+		} else {
+			glDisable(GL_DEPTH_TEST);
+		}
+		GLStateCache::depthTest = static_cast<int>(enabled);
+	}
+
+	void GLStateCache::setViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+		const std::array<GLint, 4> requested = { x, y, width, height };
+		if (GLStateCache::record(GLStateType::VIEWPORT, GLStateCache::viewport == requested)) return;
+
+		glViewport(x, y, width, height);
+		GLStateCache::viewport = requested;
+	}
+
+	void GLStateCache::forgetProgram(GLuint program) {
+		if (GLStateCache::program == program) GLStateCache::program = GLStateCache::Unknown;
+	}
+	void GLStateCache::forgetVertexArray(GLuint vertexArray) {
+		if (GLStateCache::vertexArray == vertexArray) GLStateCache::vertexArray = GLStateCache::Unknown;
+	}
+	void GLStateCache::forgetFramebuffer(GLuint framebuffer) {
+		if (GLStateCache::framebuffer == framebuffer) GLStateCache::framebuffer = GLStateCache::Unknown;
+	}
+	void GLStateCache::forgetTexture(GLuint texture) {
+		for (size_t i = 0; i < GLStateCache::TextureUnits; i++) {
+			if (GLStateCache::textures[i] == texture) {
+				GLStateCache::textures[i] = GLStateCache::Unknown;
+			}
+		}
+	}
+
+	void GLStateCache::invalidate() {
+		GLStateCache::program = GLStateCache::Unknown;
+		GLStateCache::vertexArray = GLStateCache::Unknown;
+		GLStateCache::framebuffer = GLStateCache::Unknown;
+
+		GLStateCache::activeTexture = -1;
+		GLStateCache::textures.fill(GLStateCache::Unknown);
+		GLStateCache::textureTargets.fill(0);
+
+		GLStateCache::blend = -1;
+		GLStateCache::depthTest = -1;
+		GLStateCache::blendSource = GLStateCache::Unknown;
+		GLStateCache::blendDestination = GLStateCache::Unknown;
+
+		GLStateCache::viewport = { -1, -1, -1, -1 };
+	}
+
+	GLint GLStateCache::getActiveTexture() {
+		return GLStateCache::activeTexture;
+	}
+	const GLStateStats& GLStateCache::getStats() {
+		return GLStateCache::stats;
+	}
+	void GLStateCache::resetStats() {
+		GLStateCache::stats = {};
+	}
+}
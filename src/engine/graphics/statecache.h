@@ -0,0 +1,68 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Brainstorm {
+	enum class GLStateType : size_t {
+		PROGRAM, VERTEX_ARRAY, ACTIVE_TEXTURE, TEXTURE, FRAMEBUFFER, BLEND, BLEND_FUNC, DEPTH_TEST, VIEWPORT, COUNT
+	};
+
+	struct GLStateStats {
+		std::array<uint64_t, static_cast<size_t>(GLStateType::COUNT)> issued = {};
+		std::array<uint64_t, static_cast<size_t>(GLStateType::COUNT)> skipped = {};
+
+		uint64_t getIssued() const;
+		uint64_t getSkipped() const;
+	};
+
+	// Shadow copy of the GL bindings the engine touches. Every engine class binds through here,
+	// so redundant driver calls are skipped (and counted) instead of being issued every draw.
+	// Call invalidate() after touching GL state directly, outside of the cache.
+	class GLStateCache {
+	private:
+		static const GLuint Unknown;
+		static const size_t TextureUnits = 32;
+
+		static GLuint program, vertexArray, framebuffer;
+
+		static GLint activeTexture;
+		static std::array<GLuint, TextureUnits> textures;
+		static std::array<GLenum, TextureUnits> textureTargets;
+
+		static int blend, depthTest;
+		static GLenum blendSource, blendDestination;
+
+		static std::array<GLint, 4> viewport;
+
+		static GLStateStats stats;
+
+		static inline bool record(GLStateType type, bool redundant);
+	public:
+		static void useProgram(GLuint program);
+		static void bindVertexArray(GLuint vertexArray);
+		static void bindFramebuffer(GLuint framebuffer);
+
+		static void setActiveTexture(GLint unit);
+		static void bindTexture(GLenum target, GLuint texture);
+		static void bindTexture(GLenum target, GLuint texture, GLint unit);
+
+		static void setBlend(bool enabled);
+		static void setBlendFunc(GLenum source, GLenum destination);
+		static void setDepthTest(bool enabled);
+
+		static void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+		static void forgetProgram(GLuint program);
+		static void forgetVertexArray(GLuint vertexArray);
+		static void forgetFramebuffer(GLuint framebuffer);
+		static void forgetTexture(GLuint texture);
+
+		static void invalidate();
+
+		static GLint getActiveTexture();
+		static const GLStateStats& getStats();
+		static void resetStats();
+	};
+}
@@ -15,45 +15,18 @@ namespace Brainstorm {
 	GLint Texture::CLAMP_REPEAT = GL_REPEAT;
 	GLint Texture::CLAMP_MIRRORED_REPEAT = GL_MIRRORED_REPEAT;
 
-	bool Texture::initialized = false;
-	std::array<GLuint, 32> Texture::boundIds = {};
-
 	GLuint Texture::loadFromFile(const char* location, GLint filter, GLint clamp) {
-		int width, height, channels;
-		unsigned char* pixels = stbi_load(location, &width, &height, &channels, STBI_rgb_alpha);
-
-		if (pixels == nullptr) {
-			Logger::error("Could not load texture file: \"%s\"", location);
-			return 0;
-		}
+		// Prefers the mip chain cached next to the file, the image is only decoded when that is missing or stale.
+		MipChain chain;
+		if (!TextureCache::load(location, chain)) return 0;
 
-		int format;
-		switch (channels)
-		{
-		case 4:
-			format = Texture::FORMAT_RGBA;
-			break;
-		case 3:
-			format = Texture::FORMAT_RGB;
-			break;
-		case 1:
-			format = Texture::FORMAT_R;
-			break;
-		case 2:
-			format = Texture::FORMAT_RG;
-			break;
-		default:
-			Logger::error("Format of texture at: \"%s\" is not supported.", location);
-			return 0;
-		}
-
-		return Texture::create(pixels, width, height, format, filter, clamp);
+		return Texture::create(chain, filter, clamp);
 	}
 	GLuint Texture::create(const unsigned char* data, GLsizei width, GLsizei height, GLint format, GLint filter, GLint clamp) {
 		GLuint texture;
 		
 		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
@@ -68,24 +41,40 @@ namespace Brainstorm {
 		return texture;
 	}
 
-	void Texture::use(GLuint texture, GLint index) {
-		if (index > 31) {
-			Logger::error("Texture binding index out of bounds! 0 (inclusive) - 32 (exclusive).");
-			return;
-		}
-		if (Texture::boundIds[index] == texture) {
-			return;
+	GLuint Texture::create(const MipChain& chain, GLint filter, GLint clamp) {
+		GLuint texture;
+
+		glGenTextures(1, &texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clamp);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter - GL_NEAREST + GL_NEAREST_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+		glTexStorage2D(GL_TEXTURE_2D, chain.getLevelCount(), chain.format, chain.width, chain.height);
+
+		for (GLsizei level = 0; level < chain.getLevelCount(); level++) {
+			if (chain.isCompressed()) {
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, chain.getLevelWidth(level), chain.getLevelHeight(level), chain.format, static_cast<GLsizei>(chain.sizes[level]), chain.getLevel(level));
+			} else {
+				glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, chain.getLevelWidth(level), chain.getLevelHeight(level), GL_RGBA, GL_UNSIGNED_BYTE, chain.getLevel(level));
+			}
 		}
 
-		glActiveTexture(GL_TEXTURE0 + index);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		Texture::drop();
+		return texture;
+	}
+
+	void Texture::use(GLuint texture, GLint index) {
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture, index);
 	}
 	void Texture::drop() {
-		Texture::boundIds = {};
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	void Texture::destroy(GLuint texture) {
+		GLStateCache::forgetTexture(texture);
 		glDeleteTextures(1, &texture);
 	}
 }
\ No newline at end of file
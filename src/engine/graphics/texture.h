@@ -2,13 +2,12 @@
 #include <glad/glad.h>
 #include <stb_image.h>
 #include <array>
+#include "statecache.h"
+#include "texturecache.h"
 #include "../io/logger.h"
 
 namespace Brainstorm {
 	class Texture {
-	private:
-		static bool initialized;
-		static std::array<GLuint, 32> boundIds;
 	public:
 		static GLint FORMAT_RGBA;
 		static GLint FORMAT_RGB;
@@ -25,6 +24,7 @@ namespace Brainstorm {
 
 		static GLuint loadFromFile(const char* location, GLint filter = Texture::FILTER_LINEAR, GLint clamp = Texture::CLAMP_REPEAT);
 		static GLuint create(const unsigned char* data, GLsizei width, GLsizei height, GLint format, GLint filter = Texture::FILTER_LINEAR, GLint clamp = Texture::CLAMP_REPEAT);
+		static GLuint create(const MipChain& chain, GLint filter = Texture::FILTER_LINEAR, GLint clamp = Texture::CLAMP_REPEAT);
 		
 		static void use(GLuint texture, GLint index = 0);
 		static void destroy(GLuint texture);
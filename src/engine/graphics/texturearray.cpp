@@ -0,0 +1,192 @@
+#include "texturearray.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Brainstorm {
+	inline static void resampleBox(const unsigned char* source, GLsizei sourceWidth, GLsizei sourceHeight, unsigned char* destination, GLsizei width, GLsizei height) {
+		for (GLsizei y = 0; y < height; y++) {
+			GLsizei y0 = y * sourceHeight / height;
+			GLsizei y1 = std::max((y + 1) * sourceHeight / height, y0 + 1);
+
+			for (GLsizei x = 0; x < width; x++) {
+				GLsizei x0 = x * sourceWidth / width;
+				GLsizei x1 = std::max((x + 1) * sourceWidth / width, x0 + 1);
+
+				uint32_t sum[4] = {};
+				for (GLsizei sy = y0; sy < y1; sy++) {
+					for (GLsizei sx = x0; sx < x1; sx++) {
+						for (int channel = 0; channel < 4; channel++) {
+							sum[channel] += source[(static_cast<size_t>(sy) * sourceWidth + sx) * 4 + channel];
+						}
+					}
+				}
+
+				uint32_t count = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+				for (int channel = 0; channel < 4; channel++) {
+					destination[(static_cast<size_t>(y) * width + x) * 4 + channel] = static_cast<unsigned char>((sum[channel] + count / 2) / count);
+				}
+			}
+		}
+	}
+	inline static void resampleBilinear(const unsigned char* source, GLsizei sourceWidth, GLsizei sourceHeight, unsigned char* destination, GLsizei width, GLsizei height) {
+		const float scaleX = static_cast<float>(sourceWidth) / static_cast<float>(width);
+		const float scaleY = static_cast<float>(sourceHeight) / static_cast<float>(height);
+
+		for (GLsizei y = 0; y < height; y++) {
+			float sourceY = std::max((static_cast<float>(y) + 0.5f) * scaleY - 0.5f, 0.0f);
+
+			GLsizei y0 = std::min(static_cast<GLsizei>(sourceY), sourceHeight - 1);
+			GLsizei y1 = std::min(y0 + 1, sourceHeight - 1);
+			float ty = sourceY - static_cast<float>(y0);
+
+			for (GLsizei x = 0; x < width; x++) {
+				float sourceX = std::max((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.0f);
+
+				GLsizei x0 = std::min(static_cast<GLsizei>(sourceX), sourceWidth - 1);
+				GLsizei x1 = std::min(x0 + 1, sourceWidth - 1);
+				float tx = sourceX - static_cast<float>(x0);
+
+				for (int channel = 0; channel < 4; channel++) {
+					float a = source[(y0 * sourceWidth + x0) * 4 + channel];
+					float b = source[(y0 * sourceWidth + x1) * 4 + channel];
+					float c = source[(y1 * sourceWidth + x0) * 4 + channel];
+					float d = source[(y1 * sourceWidth + x1) * 4 + channel];
+
+					float top = a + (b - a) * tx;
+					float bottom = c + (d - c) * tx;
+
+					destination[(y * width + x) * 4 + channel] = static_cast<unsigned char>(top + (bottom - top) * ty + 0.5f);
+				}
+			}
+		}
+	}
+
+	TextureArray::TextureArray(GLsizei width, GLsizei height, GLsizei capacity, GLint filter, GLint clamp)
+			: id(0), width(width), height(height), capacity(capacity), levels(1), layerCount(0) {
+		GLint maxLayers = 0;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+		if (this->capacity > maxLayers) {
+			Logger::warn("TextureArray capacity %d exceeds GL_MAX_ARRAY_TEXTURE_LAYERS (%d), clamping.", this->capacity, maxLayers);
+			this->capacity = maxLayers;
+		}
+
+		this->levels = static_cast<GLsizei>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+		glGenTextures(1, &this->id);
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, this->id);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, clamp);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, clamp);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter - GL_NEAREST + GL_NEAREST_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, this->levels, GL_RGBA8, this->width, this->height, this->capacity);
+	}
+	TextureArray::~TextureArray() {
+		this->destroy();
+	}
+
+	GLint TextureArray::addFromFile(const char* location) {
+		MipChain chain;
+		if (!TextureCache::load(location, chain, this->width, this->height, this->levels)) return -1;
+
+		GLint layer = this->allocateLayer();
+
+		for (GLsizei level = 0; layer >= 0 && level < this->levels; level++) {
+			this->setLevel(layer, level, chain.getLevel(level));
+		}
+
+		return layer;
+	}
+	GLint TextureArray::add(const unsigned char* data, GLsizei width, GLsizei height) {
+		GLint layer = this->allocateLayer();
+		if (layer < 0) return -1;
+
+		this->setLayer(layer, data, width, height);
+		return layer;
+	}
+
+	void TextureArray::setLayer(GLint layer, const unsigned char* data, GLsizei width, GLsizei height) {
+		if (layer < 0 || layer >= this->capacity) {
+			Logger::error("TextureArray layer out of bounds! 0 (inclusive) - %d (exclusive).", this->capacity);
+			return;
+		}
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, this->id);
+
+		if (width == this->width && height == this->height) {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, this->width, this->height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		} else {
+			std::vector<unsigned char> resampled(static_cast<size_t>(this->width) * this->height * 4);
+			TextureArray::resample(data, width, height, resampled.data(), this->width, this->height);
+
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, this->width, this->height, 1, GL_RGBA, GL_UNSIGNED_BYTE, resampled.data());
+		}
+	}
+
+	GLint TextureArray::allocateLayer() {
+		if (this->layerCount >= this->capacity) {
+			Logger::error("TextureArray is full! Capacity: %d layers.", this->capacity);
+			return -1;
+		}
+
+		return this->layerCount++;
+	}
+	void TextureArray::setLevel(GLint layer, GLint level, const unsigned char* data) {
+		this->setRows(layer, level, 0, std::max(this->height >> level, 1), data);
+	}
+	void TextureArray::setRows(GLint layer, GLint level, GLint y, GLsizei rows, const unsigned char* data) {
+		if (layer < 0 || layer >= this->capacity || level < 0 || level >= this->levels || y < 0 || rows < 0 || y + rows > std::max(this->height >> level, 1)) {
+			Logger::error("TextureArray layer %d level %d out of bounds!", layer, level);
+			return;
+		}
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, this->id);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, y, layer, std::max(this->width >> level, 1), rows, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
+
+	void TextureArray::resample(const unsigned char* source, GLsizei sourceWidth, GLsizei sourceHeight, unsigned char* destination, GLsizei width, GLsizei height) {
+		// Skins are usually authored larger than a layer, average the footprint instead of point sampling it.
+		if (sourceWidth >= width && sourceHeight >= height) {
+			resampleBox(source, sourceWidth, sourceHeight, destination, width, height);
+		} else {
+			resampleBilinear(source, sourceWidth, sourceHeight, destination, width, height);
+		}
+	}
+
+	void TextureArray::generateMipmaps() const {
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, this->id);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+
+	void TextureArray::use(GLint index) const {
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, this->id, index);
+	}
+	void TextureArray::destroy() {
+		GLStateCache::forgetTexture(this->id);
+		glDeleteTextures(1, &this->id);
+		this->id = 0;
+	}
+
+	GLuint TextureArray::getId() const {
+		return this->id;
+	}
+
+	GLsizei TextureArray::getWidth() const {
+		return this->width;
+	}
+	GLsizei TextureArray::getHeight() const {
+		return this->height;
+	}
+	GLsizei TextureArray::getLevels() const {
+		return this->levels;
+	}
+
+	GLsizei TextureArray::getLayerCount() const {
+		return this->layerCount;
+	}
+	GLsizei TextureArray::getCapacity() const {
+		return this->capacity;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+#include "texture.h"
+#include "../io/logger.h"
+
+namespace Brainstorm {
+	// Layered GL_TEXTURE_2D_ARRAY used as a skin atlas. Every image added is resampled
+	// to the layer size and gets its own mip chain, so instances can pick a skin by layer
+	// index and still be drawn in a single instanced call.
+	class TextureArray {
+	private:
+		GLuint id;
+
+		GLsizei width, height;
+		GLsizei capacity, levels;
+		GLsizei layerCount;
+	public:
+		TextureArray(GLsizei width, GLsizei height, GLsizei capacity, GLint filter = Texture::FILTER_LINEAR, GLint clamp = Texture::CLAMP_TO_EDGE);
+		~TextureArray();
+
+		GLint addFromFile(const char* location);
+		GLint add(const unsigned char* data, GLsizei width, GLsizei height);
+
+		void setLayer(GLint layer, const unsigned char* data, GLsizei width, GLsizei height);
+
+		// For uploads that bring their own mip chain: takes the next free layer without writing to it,
+		// the levels are then filled one by one at their exact size.
+		GLint allocateLayer();
+		void setLevel(GLint layer, GLint level, const unsigned char* data);
+		// Rows y to y + rows of a level, data holds just those rows.
+		void setRows(GLint layer, GLint level, GLint y, GLsizei rows, const unsigned char* data);
+
+		// RGBA8 resampling as used by setLayer, box filtered when shrinking and bilinear when growing.
+		static void resample(const unsigned char* source, GLsizei sourceWidth, GLsizei sourceHeight, unsigned char* destination, GLsizei width, GLsizei height);
+		void generateMipmaps() const;
+
+		void use(GLint index = 0) const;
+		void destroy();
+
+		GLuint getId() const;
+
+		GLsizei getWidth() const;
+		GLsizei getHeight() const;
+		GLsizei getLevels() const;
+
+		GLsizei getLayerCount() const;
+		GLsizei getCapacity() const;
+	};
+}
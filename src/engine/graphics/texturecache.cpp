@@ -0,0 +1,403 @@
+#include "texturecache.h"
+#include "texture.h"
+#include "texturearray.h"
+#include "../io/logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace Brainstorm {
+	static const uint32_t CacheMagic = 0x58545342; // "BSTX"
+	static const uint32_t CacheVersion = 1;
+
+	enum class CacheFormat : uint32_t {
+		RGBA8 = 0, BC3 = 1
+	};
+
+	struct CacheHeader {
+		uint32_t magic, version;
+		uint32_t width, height;
+		uint32_t format, levels;
+	};
+	struct CacheLevel {
+		uint64_t offset, size;
+	};
+
+	std::atomic<bool> TextureCache::compression = false;
+
+	// Largest side a cache may declare, anything above is a corrupt header.
+	static const uint32_t MaxCacheSize = 16384;
+
+	static uint64_t getLevelSize(CacheFormat format, uint32_t width, uint32_t height) {
+		if (format == CacheFormat::BC3) {
+			return static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+		}
+		return static_cast<uint64_t>(width) * height * 4;
+	}
+
+	const unsigned char* MipChain::getData() const {
+		return this->mapping != nullptr ? this->mapping->getData() : this->storage.data();
+	}
+	const unsigned char* MipChain::getLevel(size_t level) const {
+		return this->getData() + this->offsets[level];
+	}
+	size_t MipChain::getSize() const {
+		return this->offsets.empty() ? 0 : this->offsets.back() + this->sizes.back();
+	}
+
+	GLsizei MipChain::getLevelCount() const {
+		return static_cast<GLsizei>(this->offsets.size());
+	}
+	GLsizei MipChain::getLevelWidth(size_t level) const {
+		return std::max(this->width >> level, 1);
+	}
+	GLsizei MipChain::getLevelHeight(size_t level) const {
+		return std::max(this->height >> level, 1);
+	}
+
+	bool MipChain::isCompressed() const {
+		return this->format != GL_RGBA8;
+	}
+
+	MipChain MipChain::build(const unsigned char* pixels, GLsizei sourceWidth, GLsizei sourceHeight, GLsizei width, GLsizei height, GLsizei levels) {
+		MipChain chain;
+		chain.width = width;
+		chain.height = height;
+
+		size_t size = 0;
+		for (GLsizei level = 0; level < levels; level++) {
+			size_t levelSize = static_cast<size_t>(chain.getLevelWidth(level)) * chain.getLevelHeight(level) * 4;
+
+			chain.offsets.push_back(size);
+			chain.sizes.push_back(levelSize);
+			size += levelSize;
+		}
+		chain.storage.resize(size);
+
+		if (width == sourceWidth && height == sourceHeight) {
+			std::memcpy(chain.storage.data(), pixels, chain.sizes[0]);
+		} else {
+			TextureArray::resample(pixels, sourceWidth, sourceHeight, chain.storage.data(), width, height);
+		}
+
+		for (GLsizei level = 1; level < levels; level++) {
+			TextureArray::resample(
+				chain.storage.data() + chain.offsets[level - 1], chain.getLevelWidth(level - 1), chain.getLevelHeight(level - 1),
+				chain.storage.data() + chain.offsets[level], chain.getLevelWidth(level), chain.getLevelHeight(level)
+			);
+		}
+
+		return chain;
+	}
+
+	inline static uint16_t packColor(const float* color) {
+		uint16_t r = static_cast<uint16_t>(std::clamp(color[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+		uint16_t g = static_cast<uint16_t>(std::clamp(color[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+		uint16_t b = static_cast<uint16_t>(std::clamp(color[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+
+		return static_cast<uint16_t>(r << 11 | g << 5 | b);
+	}
+	inline static void unpackColor(uint16_t packed, int* color) {
+		color[0] = ((packed >> 11) & 31) * 255 / 31;
+		color[1] = ((packed >> 5) & 63) * 255 / 63;
+		color[2] = (packed & 31) * 255 / 31;
+	}
+
+	// Bounding box fit: endpoints are the inset corners of the block's color box, every pixel takes the
+	// nearest of the four palette entries. Alpha gets its own min/max ramp of eight values.
+	static void compressBlock(const unsigned char block[16][4], unsigned char* output) {
+		float minimum[3] = { 255.0f, 255.0f, 255.0f }, maximum[3] = { 0.0f, 0.0f, 0.0f };
+		unsigned char minimumAlpha = 255, maximumAlpha = 0;
+
+		for (int i = 0; i < 16; i++) {
+			for (int channel = 0; channel < 3; channel++) {
+				minimum[channel] = std::min(minimum[channel], static_cast<float>(block[i][channel]));
+				maximum[channel] = std::max(maximum[channel], static_cast<float>(block[i][channel]));
+			}
+
+			minimumAlpha = std::min(minimumAlpha, block[i][3]);
+			maximumAlpha = std::max(maximumAlpha, block[i][3]);
+		}
+
+		for (int channel = 0; channel < 3; channel++) {
+			float inset = (maximum[channel] - minimum[channel]) / 16.0f;
+			minimum[channel] += inset;
+			maximum[channel] -= inset;
+		}
+
+		// Alpha block: endpoints, then 16 three bit indices.
+		output[0] = maximumAlpha;
+		output[1] = minimumAlpha;
+
+		uint64_t alphaIndices = 0;
+		if (maximumAlpha > minimumAlpha) {
+			for (int i = 0; i < 16; i++) {
+				// Position on the ramp from the minimum (0) to the maximum (7), mapped to the index order of BC3.
+				int position = (static_cast<int>(block[i][3] - minimumAlpha) * 7 + (maximumAlpha - minimumAlpha) / 2) / (maximumAlpha - minimumAlpha);
+				uint64_t index = position == 7 ? 0 : position == 0 ? 1 : static_cast<uint64_t>(8 - position);
+
+				alphaIndices |= index << (3 * i);
+			}
+		}
+		for (int i = 0; i < 6; i++) {
+			output[2 + i] = static_cast<unsigned char>(alphaIndices >> (8 * i));
+		}
+
+		// Color block in four color mode, which needs the first endpoint to be the larger one.
+		uint16_t color0 = packColor(maximum), color1 = packColor(minimum);
+		if (color0 < color1) std::swap(color0, color1);
+
+		int palette[4][3];
+		unpackColor(color0, palette[0]);
+		unpackColor(color1, palette[1]);
+		for (int channel = 0; channel < 3; channel++) {
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+
+		uint32_t colorIndices = 0;
+		if (color0 != color1) {
+			for (int i = 0; i < 16; i++) {
+				int best = 0, bestDistance = INT32_MAX;
+
+				for (int entry = 0; entry < 4; entry++) {
+					int distance = 0;
+					for (int channel = 0; channel < 3; channel++) {
+						int difference = block[i][channel] - palette[entry][channel];
+						distance += difference * difference;
+					}
+
+					if (distance < bestDistance) {
+						best = entry;
+						bestDistance = distance;
+					}
+				}
+
+				colorIndices |= static_cast<uint32_t>(best) << (2 * i);
+			}
+		}
+
+		std::memcpy(output + 8, &color0, 2);
+		std::memcpy(output + 10, &color1, 2);
+		std::memcpy(output + 12, &colorIndices, 4);
+	}
+
+	MipChain MipChain::compress() const {
+		MipChain chain;
+		chain.width = this->width;
+		chain.height = this->height;
+		chain.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+		size_t size = 0;
+		for (GLsizei level = 0; level < this->getLevelCount(); level++) {
+			size_t levelSize = static_cast<size_t>((this->getLevelWidth(level) + 3) / 4) * ((this->getLevelHeight(level) + 3) / 4) * 16;
+
+			chain.offsets.push_back(size);
+			chain.sizes.push_back(levelSize);
+			size += levelSize;
+		}
+		chain.storage.resize(size);
+
+		for (GLsizei level = 0; level < this->getLevelCount(); level++) {
+			const unsigned char* source = this->getLevel(level);
+			unsigned char* destination = chain.storage.data() + chain.offsets[level];
+
+			GLsizei width = this->getLevelWidth(level), height = this->getLevelHeight(level);
+
+			for (GLsizei y = 0; y < height; y += 4) {
+				for (GLsizei x = 0; x < width; x += 4) {
+					// Blocks hanging over the edge of small levels repeat the last row and column.
+					unsigned char block[16][4];
+					for (int i = 0; i < 16; i++) {
+						GLsizei sx = std::min(x + i % 4, width - 1), sy = std::min(y + i / 4, height - 1);
+						std::memcpy(block[i], source + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+					}
+
+					compressBlock(block, destination);
+					destination += 16;
+				}
+			}
+		}
+
+		return chain;
+	}
+
+	std::string TextureCache::getCacheLocation(const char* location) {
+		return std::string(location) + ".bstex";
+	}
+
+	void TextureCache::setCompression(bool enabled) {
+		bool supported = false;
+
+		GLint extensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+
+		for (GLint i = 0; i < extensions && enabled; i++) {
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+			supported |= extension != nullptr && std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0;
+		}
+
+		if (enabled && !supported) {
+			Logger::warn("S3TC is not supported by the driver, texture caches stay uncompressed.");
+		}
+
+		TextureCache::compression.store(enabled && supported, std::memory_order_relaxed);
+	}
+	bool TextureCache::isCompressionEnabled() {
+		return TextureCache::compression.load(std::memory_order_relaxed);
+	}
+
+	bool TextureCache::load(const char* location, MipChain& chain, GLsizei width, GLsizei height, GLsizei levels) {
+		std::string cacheLocation = TextureCache::getCacheLocation(location);
+		std::error_code error;
+
+		// A cache without its source is fine, that is how prebuilt caches ship.
+		bool fresh = std::filesystem::exists(cacheLocation, error) &&
+			(!std::filesystem::exists(location, error) || std::filesystem::last_write_time(cacheLocation, error) >= std::filesystem::last_write_time(location, error));
+
+		bool layer = width > 0 && height > 0;
+
+		if (fresh && TextureCache::read(cacheLocation.c_str(), chain)) {
+			bool matches = !layer || (chain.width == width && chain.height == height && chain.getLevelCount() == levels && !chain.isCompressed());
+			if (matches && (!chain.isCompressed() || TextureCache::isCompressionEnabled())) return true;
+		}
+
+		int sourceWidth, sourceHeight, channels;
+		unsigned char* pixels = stbi_load(location, &sourceWidth, &sourceHeight, &channels, STBI_rgb_alpha);
+
+		if (pixels == nullptr) {
+			Logger::error("Could not load texture file: \"%s\"", location);
+			return false;
+		}
+
+		if (!layer) {
+			width = sourceWidth;
+			height = sourceHeight;
+			levels = static_cast<GLsizei>(std::floor(std::log2(std::max(width, height)))) + 1;
+		}
+
+		chain = MipChain::build(pixels, sourceWidth, sourceHeight, width, height, levels);
+		stbi_image_free(pixels);
+
+		if (!layer && TextureCache::isCompressionEnabled()) {
+			chain = chain.compress();
+		}
+
+		TextureCache::write(cacheLocation.c_str(), chain);
+		return true;
+	}
+
+	bool TextureCache::read(const char* location, MipChain& chain) {
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+		if (!file->open(location)) return false;
+
+		CacheHeader header;
+		if (file->getSize() < sizeof(CacheHeader)) return false;
+		std::memcpy(&header, file->getData(), sizeof(CacheHeader));
+
+		if (header.magic != CacheMagic || header.version != CacheVersion) {
+			Logger::warn("Ignoring texture cache \"%s\" of an unknown version.", location);
+			return false;
+		}
+
+		CacheFormat format = static_cast<CacheFormat>(header.format);
+		bool valid = header.width > 0 && header.width <= MaxCacheSize && header.height > 0 && header.height <= MaxCacheSize &&
+			(format == CacheFormat::RGBA8 || format == CacheFormat::BC3) &&
+			header.levels > 0 && header.levels <= static_cast<uint32_t>(std::floor(std::log2(std::max(header.width, header.height)))) + 1;
+
+		if (!valid) {
+			Logger::warn("Ignoring texture cache \"%s\" with a corrupt header.", location);
+			return false;
+		}
+
+		size_t tableEnd = sizeof(CacheHeader) + header.levels * sizeof(CacheLevel);
+		if (file->getSize() < tableEnd) return false;
+
+		MipChain result;
+		result.width = static_cast<GLsizei>(header.width);
+		result.height = static_cast<GLsizei>(header.height);
+		result.format = format == CacheFormat::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA8;
+
+		for (uint32_t i = 0; i < header.levels; i++) {
+			CacheLevel level;
+			std::memcpy(&level, file->getData() + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(CacheLevel));
+
+			// The upload reads exactly the size the level's dimensions ask for, the table has to agree.
+			uint64_t expected = getLevelSize(format, std::max(header.width >> i, 1u), std::max(header.height >> i, 1u));
+			// And the levels packed back to back after the table, the loader copies them as one block.
+			uint64_t offset = i == 0 ? tableEnd : result.offsets.back() + result.sizes.back();
+			if (level.size != expected || (i == 0 ? level.offset < offset : level.offset != offset)) {
+				Logger::warn("Ignoring texture cache \"%s\" with a corrupt level table.", location);
+				return false;
+			}
+
+			if (level.offset > file->getSize() || level.size > file->getSize() - level.offset) {
+				Logger::warn("Texture cache \"%s\" is truncated.", location);
+				return false;
+			}
+
+			result.offsets.push_back(static_cast<size_t>(level.offset));
+			result.sizes.push_back(static_cast<size_t>(level.size));
+		}
+
+		result.mapping = file;
+		chain = std::move(result);
+
+		return true;
+	}
+	bool TextureCache::write(const char* location, const MipChain& chain) {
+		// Written next to the cache and renamed over it once complete, so a reader never maps a partial file
+		// and two workers, or two instances, caching the same texture do not write into each other.
+		static const uint32_t Instance = std::random_device()();
+		static std::atomic<uint32_t> writeCount = 0;
+		std::string temporary = std::string(location) + "." + std::to_string(Instance) + "." + std::to_string(writeCount.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+		std::ofstream file(temporary, std::ios::binary);
+
+		if (!file.is_open()) {
+			Logger::warn("Could not write texture cache \"%s\".", location);
+			return false;
+		}
+
+		CacheHeader header = {
+			CacheMagic, CacheVersion,
+			static_cast<uint32_t>(chain.width), static_cast<uint32_t>(chain.height),
+			static_cast<uint32_t>(chain.isCompressed() ? CacheFormat::BC3 : CacheFormat::RGBA8), static_cast<uint32_t>(chain.getLevelCount())
+		};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+
+		// Levels start 16 byte aligned behind the table.
+		uint64_t offset = (sizeof(CacheHeader) + chain.getLevelCount() * sizeof(CacheLevel) + 15) & ~static_cast<uint64_t>(15);
+		uint64_t start = offset;
+
+		for (GLsizei i = 0; i < chain.getLevelCount(); i++) {
+			CacheLevel level = { start + chain.offsets[i], chain.sizes[i] };
+			file.write(reinterpret_cast<const char*>(&level), sizeof(CacheLevel));
+		}
+
+		const char Zero[16] = {};
+		file.write(Zero, static_cast<std::streamsize>(offset - sizeof(CacheHeader) - chain.getLevelCount() * sizeof(CacheLevel)));
+		file.write(reinterpret_cast<const char*>(chain.getData()), static_cast<std::streamsize>(chain.getSize()));
+		file.close();
+
+		std::error_code error;
+		if (!file.good()) {
+			Logger::warn("Could not write texture cache \"%s\".", location);
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+
+		std::filesystem::rename(temporary, location, error);
+		if (error) {
+			Logger::warn("Could not replace texture cache \"%s\": %s", location, error.message().c_str());
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+
+		return true;
+	}
+}
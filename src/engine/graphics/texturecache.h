@@ -0,0 +1,63 @@
+#pragma once
+#include <glad/glad.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../util/mappedfile.h"
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace Brainstorm {
+	// Every mip level of a texture in one block of memory, either owned or pointing into a mapped cache file.
+	struct MipChain {
+		GLsizei width = 0, height = 0;
+		GLenum format = GL_RGBA8; // GL_RGBA8 or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3)
+
+		std::vector<size_t> offsets, sizes;
+
+		std::vector<unsigned char> storage;
+		std::shared_ptr<MappedFile> mapping;
+
+		const unsigned char* getData() const;
+		const unsigned char* getLevel(size_t level) const;
+		size_t getSize() const;
+
+		GLsizei getLevelCount() const;
+		GLsizei getLevelWidth(size_t level) const;
+		GLsizei getLevelHeight(size_t level) const;
+
+		bool isCompressed() const;
+
+		// Resamples RGBA8 pixels to the given size and box filters every level below it.
+		static MipChain build(const unsigned char* pixels, GLsizei sourceWidth, GLsizei sourceHeight, GLsizei width, GLsizei height, GLsizei levels);
+		MipChain compress() const;
+	};
+
+	// Decoded textures are cached next to their source as "<name>.bstex": a header, a level table and the
+	// pre-built mip chain, optionally BC3 compressed. The cache is memory mapped and used as long as it is
+	// not older than the source, otherwise the source is decoded again and the cache rewritten.
+	class TextureCache {
+	private:
+		static std::atomic<bool> compression;
+	public:
+		static std::string getCacheLocation(const char* location);
+
+		// Compressed caches are written and accepted only when enabled and the driver has S3TC. GL thread,
+		// the window enables it right after loading GL, before any loader worker runs.
+		static void setCompression(bool enabled);
+		static bool isCompressionEnabled();
+
+		// Fills chain from the cache or the source. A width and height of 0 keep the size of the image,
+		// layers of a TextureArray ask for theirs and always get uncompressed levels.
+		static bool load(const char* location, MipChain& chain, GLsizei width = 0, GLsizei height = 0, GLsizei levels = 0);
+
+		static bool read(const char* location, MipChain& chain);
+		static bool write(const char* location, const MipChain& chain);
+	};
+}
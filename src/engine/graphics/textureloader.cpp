@@ -0,0 +1,254 @@
+#include "textureloader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Brainstorm {
+	TextureLoader::TextureLoader(size_t workerCount) : running(true), handleCount(0), placeholder(0), nextBuffer(0), uploading(false) {
+		for (std::atomic<GLint>& value : this->resolved) {
+			value.store(Pending, std::memory_order_relaxed);
+		}
+
+		const unsigned char White[4] = { 255, 255, 255, 255 };
+
+		glGenTextures(1, &this->placeholder);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, this->placeholder);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, White);
+
+		glGenBuffers(static_cast<GLsizei>(this->buffers.size()), this->buffers.data());
+
+		for (size_t i = 0; i < std::max(workerCount, static_cast<size_t>(1)); i++) {
+			this->workers.emplace_back(&TextureLoader::work, this);
+		}
+	}
+	TextureLoader::~TextureLoader() {
+		this->destroy();
+	}
+
+	TextureHandle TextureLoader::request(const char* location, TextureArray* array, GLint filter, GLint clamp) {
+		TextureHandle handle = this->handleCount.fetch_add(1, std::memory_order_relaxed);
+
+		if (handle >= MaxHandles) {
+			Logger::error("TextureLoader is out of handles! Capacity: %zu.", MaxHandles);
+			return InvalidHandle;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->requestMutex);
+			this->requests.push_back({ handle, location, array, filter, clamp });
+		}
+		this->requestCondition.notify_one();
+
+		return handle;
+	}
+	TextureHandle TextureLoader::load(const char* location, GLint filter, GLint clamp) {
+		return this->request(location, nullptr, filter, clamp);
+	}
+	TextureHandle TextureLoader::loadLayer(const char* location, TextureArray& array) {
+		return this->request(location, &array, Texture::FILTER_LINEAR, Texture::CLAMP_TO_EDGE);
+	}
+
+	void TextureLoader::work() {
+		while (true) {
+			Request request;
+			{
+				std::unique_lock<std::mutex> lock(this->requestMutex);
+				this->requestCondition.wait(lock, [this]() { return !this->requests.empty() || !this->running; });
+
+				if (!this->running) return;
+
+				request = std::move(this->requests.front());
+				this->requests.pop_front();
+			}
+
+			Decoded result;
+			result.request = request;
+
+			// Layers have a fixed size, everything else keeps the size of the image.
+			bool loaded = request.array != nullptr
+				? TextureCache::load(request.location.c_str(), result.chain, request.array->getWidth(), request.array->getHeight(), request.array->getLevels())
+				: TextureCache::load(request.location.c_str(), result.chain);
+
+			if (!loaded) {
+				this->resolved[request.handle].store(Failed, std::memory_order_release);
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(this->decodedMutex);
+			this->decoded.push_back(std::move(result));
+		}
+	}
+
+	bool TextureLoader::begin() {
+		const Request& request = this->current.decoded.request;
+		const MipChain& chain = this->current.decoded.chain;
+
+		if (request.array != nullptr) {
+			this->current.value = request.array->allocateLayer();
+			return this->current.value >= 0;
+		}
+
+		GLuint texture;
+
+		glGenTextures(1, &texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, request.clamp);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, request.clamp);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, request.filter - GL_NEAREST + GL_NEAREST_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, request.filter);
+
+		glTexStorage2D(GL_TEXTURE_2D, chain.getLevelCount(), chain.format, chain.width, chain.height);
+
+		this->textures.push_back(texture);
+		this->current.value = static_cast<GLint>(texture);
+
+		return true;
+	}
+
+	size_t TextureLoader::copy(size_t budget, bool force) {
+		const Request& request = this->current.decoded.request;
+		const MipChain& chain = this->current.decoded.chain;
+
+		GLsizei level = this->current.level;
+		GLsizei width = chain.getLevelWidth(level);
+		GLsizei height = chain.getLevelHeight(level);
+
+		// BC3 blocks cover 4 rows, a compressed level is only split between block rows.
+		GLsizei blockHeight = chain.isCompressed() ? 4 : 1;
+		GLsizei rows = (height + blockHeight - 1) / blockHeight;
+		size_t rowSize = chain.sizes[level] / static_cast<size_t>(rows);
+
+		GLsizei count = static_cast<GLsizei>(std::min(budget / rowSize, static_cast<size_t>(rows - this->current.row)));
+		if (count == 0) {
+			if (!force) return 0;
+			count = 1;
+		}
+
+		size_t size = static_cast<size_t>(count) * rowSize;
+
+		GLuint buffer = this->buffers[this->nextBuffer];
+		this->nextBuffer = (this->nextBuffer + 1) % this->buffers.size();
+
+		// Orphaning gives fresh storage, so the copy never waits for the GPU to finish reading the last upload.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+
+		void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped == nullptr) {
+			Logger::error("Could not map the upload buffer for \"%s\".", request.location.c_str());
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			this->finish(Failed);
+			return size;
+		}
+
+		std::memcpy(mapped, chain.getLevel(level) + static_cast<size_t>(this->current.row) * rowSize, size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		GLint y = this->current.row * blockHeight;
+		GLsizei copied = std::min(count * blockHeight, height - y);
+
+		// With an unpack buffer bound the data pointer is a byte offset into it.
+		if (request.array != nullptr) {
+			request.array->setRows(this->current.value, level, y, copied, nullptr);
+		} else {
+			GLStateCache::bindTexture(GL_TEXTURE_2D, static_cast<GLuint>(this->current.value));
+
+			if (chain.isCompressed()) {
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, copied, chain.format, static_cast<GLsizei>(size), nullptr);
+			} else {
+				glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, copied, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		this->current.row += count;
+		if (this->current.row == rows) {
+			this->current.level++;
+			this->current.row = 0;
+		}
+
+		if (this->current.level == chain.getLevelCount()) {
+			this->finish(this->current.value);
+		}
+
+		return size;
+	}
+
+	void TextureLoader::finish(GLint value) {
+		this->resolved[this->current.decoded.request.handle].store(value, std::memory_order_release);
+
+		// Releases the pixels, or the cache mapping, right away.
+		this->current = {};
+		this->uploading = false;
+	}
+
+	void TextureLoader::update(size_t byteBudget) {
+		size_t copied = 0;
+
+		while (copied < byteBudget) {
+			if (!this->uploading) {
+				{
+					std::lock_guard<std::mutex> lock(this->decodedMutex);
+					if (this->decoded.empty()) return;
+
+					this->current = {};
+					this->current.decoded = std::move(this->decoded.front());
+					this->decoded.pop_front();
+				}
+
+				this->uploading = true;
+
+				if (!this->begin()) {
+					this->finish(Failed);
+					continue;
+				}
+			}
+
+			size_t size = this->copy(byteBudget - copied, copied == 0);
+			if (size == 0) return;
+
+			copied += size;
+		}
+	}
+
+	GLuint TextureLoader::get(TextureHandle handle) const {
+		GLint value = handle < MaxHandles ? this->resolved[handle].load(std::memory_order_acquire) : Failed;
+		return value >= 0 ? static_cast<GLuint>(value) : this->placeholder;
+	}
+	GLint TextureLoader::getLayer(TextureHandle handle) const {
+		GLint value = handle < MaxHandles ? this->resolved[handle].load(std::memory_order_acquire) : Failed;
+		return value >= 0 ? value : -1;
+	}
+	bool TextureLoader::isReady(TextureHandle handle) const {
+		return handle < MaxHandles && this->resolved[handle].load(std::memory_order_acquire) >= 0;
+	}
+
+	void TextureLoader::destroy() {
+		if (this->placeholder == 0) return;
+
+		{
+			std::lock_guard<std::mutex> lock(this->requestMutex);
+			this->running = false;
+		}
+		this->requestCondition.notify_all();
+
+		for (std::thread& worker : this->workers) {
+			worker.join();
+		}
+		this->workers.clear();
+
+		for (GLuint texture : this->textures) {
+			Texture::destroy(texture);
+		}
+		this->textures.clear();
+
+		glDeleteBuffers(static_cast<GLsizei>(this->buffers.size()), this->buffers.data());
+
+		Texture::destroy(this->placeholder);
+		this->placeholder = 0;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "texture.h"
+#include "texturearray.h"
+#include "texturecache.h"
+
+namespace Brainstorm {
+	typedef uint32_t TextureHandle;
+
+	// Streams textures in without stalling a frame. Workers map the texture cache or decode the image and
+	// build its whole mip chain, then the GL thread copies a bounded amount per frame into a pixel buffer object and
+	// uploads from it into immutable storage. Until then a handle resolves to its placeholder.
+	class TextureLoader {
+	public:
+		static const TextureHandle InvalidHandle = UINT32_MAX;
+		static const size_t MaxHandles = 1024;
+	private:
+		struct Request {
+			TextureHandle handle;
+			std::string location;
+
+			TextureArray* array; // nullptr for a standalone 2D texture
+			GLint filter, clamp;
+		};
+		struct Decoded {
+			Request request;
+			MipChain chain;
+		};
+		// The texture being copied over, it carries on into the next frames once the budget runs out.
+		struct Upload {
+			Decoded decoded;
+			GLint value = Failed; // Texture id or layer the rows go into
+			GLsizei level = 0, row = 0; // Next row to copy, in 4x4 block rows for compressed chains
+		};
+
+		std::vector<std::thread> workers;
+
+		std::mutex requestMutex, decodedMutex;
+		std::condition_variable requestCondition;
+
+		std::deque<Request> requests;
+		std::deque<Decoded> decoded;
+		bool running;
+
+		// Texture id or layer once uploaded, Pending before and Failed if it could not be loaded.
+		std::array<std::atomic<GLint>, MaxHandles> resolved;
+		std::atomic<TextureHandle> handleCount;
+
+		GLuint placeholder;
+		std::array<GLuint, 2> buffers;
+		size_t nextBuffer;
+
+		std::vector<GLuint> textures;
+
+		Upload current;
+		bool uploading;
+
+		TextureHandle request(const char* location, TextureArray* array, GLint filter, GLint clamp);
+
+		void work();
+
+		// Creates the texture or takes the layer, the levels are filled by copy().
+		bool begin();
+		// Copies whole rows of the current level, as many as fit in budget or a single one if force is set.
+		// Returns the bytes copied.
+		size_t copy(size_t budget, bool force);
+		void finish(GLint value);
+	public:
+		static const GLint Pending = -1;
+		static const GLint Failed = -2;
+
+		// Needs the GL context for the placeholder, a white pixel.
+		TextureLoader(size_t workerCount = 2);
+		~TextureLoader();
+
+		// Thread safe, the returned handle is valid immediately.
+		TextureHandle load(const char* location, GLint filter = Texture::FILTER_LINEAR, GLint clamp = Texture::CLAMP_REPEAT);
+		TextureHandle loadLayer(const char* location, TextureArray& array);
+
+		// Thread safe. The placeholder, or -1 for layers, until the texture is ready.
+		GLuint get(TextureHandle handle) const;
+		GLint getLayer(TextureHandle handle) const;
+		bool isReady(TextureHandle handle) const;
+
+		// GL thread, once per frame. Copies at most byteBudget bytes, in whole rows of a level, so a large
+		// texture is spread over several frames and shows up once all of its levels are in. The only overshoot
+		// is a single row wider than the whole budget, copied alone so it still makes progress.
+		void update(size_t byteBudget = 4 << 20);
+
+		void destroy();
+	};
+}
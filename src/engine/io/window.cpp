@@ -1,10 +1,12 @@
 #include "window.h"
+#include "../graphics/statecache.h"
+#include "../graphics/texturecache.h"
 #include "stb_image.h"
 
 #define HWND static_cast<GLFWwindow*>(Window::handle)
 
 namespace Brainstorm {
-    bool Window::created = false, Window::closed = false;
+    bool Window::created = false, Window::closed = false, Window::headless = false;
 
     float Window::aspect;
 
@@ -40,12 +42,17 @@ namespace Brainstorm {
         Window::eventCache.framebufferHeight = 0;
     }
 
-	void Window::create(int width, int height, const char* title) {
+	void Window::create(int width, int height, const char* title, bool headless) {
         if (Window::created) {
             Logger::error("Window already created!");
             return;
         }
         Window::created = true;
+        Window::headless = headless;
+
+        if (headless) {
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
 
         if (!glfwInit()) {
             Logger::fatal("Could not initialize Brainstorm.");
@@ -55,20 +62,27 @@ namespace Brainstorm {
         stbi_set_flip_vertically_on_load(true);
         Logger::info("Brainstorm initialized.\n");
 
-        if ((Window::handle = glfwCreateWindow(width, height, title, nullptr, nullptr)) == nullptr) {
+        if (headless) {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+            // Surfaceless EGL is not available everywhere, OSMesa always renders in system memory.
+            if ((Window::handle = glfwCreateWindow(width, height, title, nullptr, nullptr)) == nullptr) {
+                Logger::warn("No EGL context for the headless window, falling back to OSMesa.");
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            }
+        }
+
+        if (Window::handle == nullptr && (Window::handle = glfwCreateWindow(width, height, title, nullptr, nullptr)) == nullptr) {
             Logger::error("Could not create the window. Params: width=%d, height=%d, title=\"%s\".", width, height, title);
             return;
         }
 
-        float aspect = static_cast<float>(width) / static_cast<float>(height);
+        Window::aspect = static_cast<float>(width) / static_cast<float>(height);
 
+        // Callbacks run on the event thread, which may not own the context. The thread drawing
+        // the frame applies the new size through Window::updateViewport().
         glfwSetFramebufferSizeCallback(HWND, [](GLFWwindow* window, int width, int height) -> void {
-            ViewportBounds bounds = Window::viewportBounds;
-            glViewport(
-                static_cast<GLint>(bounds.offset.x * width), static_cast<GLint>(bounds.offset.y * height),
-                static_cast<GLint>(bounds.scale.x * width), static_cast<GLint>(bounds.scale.y * height)
-            );
-
             Window::aspect = static_cast<float>(width) / static_cast<float>(height);
             
             Window::resetEventCache();
@@ -177,7 +191,10 @@ namespace Brainstorm {
             return;
         }
 
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // Before any texture loads, BC3 caches are used wherever the driver has S3TC.
+        TextureCache::setCompression(true);
+
+        GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
 	}
     void Window::close() {
@@ -200,7 +217,6 @@ namespace Brainstorm {
 
     void Window::pollEvents() {
         glfwPollEvents();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         Window::currentFrame++;
 
         Window::mouseScrollCapture = Window::mouseScroll;
@@ -218,8 +234,27 @@ namespace Brainstorm {
         }
     }
     void Window::swapBuffers() {
+        if (Window::headless) return;
         glfwSwapBuffers(HWND);
     }
+    void Window::clear() {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void Window::attachContext() {
+        glfwMakeContextCurrent(HWND);
+    }
+    void Window::detachContext() {
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    void Window::updateViewport(int framebufferWidth, int framebufferHeight) {
+        ViewportBounds bounds = Window::viewportBounds;
+        GLStateCache::setViewport(
+            static_cast<GLint>(bounds.offset.x * framebufferWidth), static_cast<GLint>(bounds.offset.y * framebufferHeight),
+            static_cast<GLint>(bounds.scale.x * framebufferWidth), static_cast<GLint>(bounds.scale.y * framebufferHeight)
+        );
+    }
 
     void Window::setEventCallback(const EventCallback callback) {
         Window::eventCallback = callback;
@@ -228,6 +263,9 @@ namespace Brainstorm {
     float Window::getAspect() {
         return Window::aspect;
     }
+    bool Window::isHeadless() {
+        return Window::headless;
+    }
 
     bool Window::isRunning() {
         return !glfwWindowShouldClose(HWND);
@@ -50,7 +50,7 @@ namespace Brainstorm {
 
 	class Window {
 	private:
-		static bool created, closed;
+		static bool created, closed, headless;
 
 		static unsigned int *keys, *buttons;
 		static void* handle;
@@ -69,14 +69,23 @@ namespace Brainstorm {
 
 		static float aspect;
 
-		static void create(int width, int height, const char* title);
+		// Headless windows are never shown and need no display: GLFW's null platform with an EGL or OSMesa
+		// context, which Mesa backs with its software rasterizer. Draw into a FrameBuffer, there is nothing to swap.
+		static void create(int width, int height, const char* title, bool headless = false);
 		static void swapBuffers();
 		static void pollEvents();
+		static void clear();
 		static void close();
+
+		static void attachContext();
+		static void detachContext();
+
+		static void updateViewport(int framebufferWidth, int framebufferHeight);
 		
 		static void setEventCallback(const EventCallback callback);
 
 		static float getAspect();
+		static bool isHeadless();
 
 		static void addRunnable(Runnable* runnable);
 		static bool isRunning();
@@ -0,0 +1,95 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Brainstorm {
+#ifdef _WIN32
+	MappedFile::MappedFile() : data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+#else
+	MappedFile::MappedFile() : data(nullptr), size(0), file(-1) {}
+#endif
+	MappedFile::~MappedFile() {
+		this->close();
+	}
+
+	bool MappedFile::open(const char* location) {
+		this->close();
+
+#ifdef _WIN32
+		this->file = CreateFileA(location, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (this->file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(this->file, &size) || size.QuadPart == 0) {
+			this->close();
+			return false;
+		}
+		this->size = static_cast<size_t>(size.QuadPart);
+
+		this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (this->mapping == nullptr) {
+			this->close();
+			return false;
+		}
+
+		this->data = static_cast<const unsigned char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		this->file = ::open(location, O_RDONLY);
+		if (this->file < 0) return false;
+
+		struct stat status;
+		if (fstat(this->file, &status) != 0 || status.st_size == 0) {
+			this->close();
+			return false;
+		}
+		this->size = static_cast<size_t>(status.st_size);
+
+		void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, this->file, 0);
+		this->data = mapped != MAP_FAILED ? static_cast<const unsigned char*>(mapped) : nullptr;
+#endif
+
+		if (this->data == nullptr) {
+			this->close();
+			return false;
+		}
+
+		return true;
+	}
+	void MappedFile::close() {
+#ifdef _WIN32
+		if (this->data != nullptr) UnmapViewOfFile(this->data);
+		if (this->mapping != nullptr) CloseHandle(this->mapping);
+		if (this->file != INVALID_HANDLE_VALUE) CloseHandle(this->file);
+
+		this->mapping = nullptr;
+		this->file = INVALID_HANDLE_VALUE;
+#else
+		if (this->data != nullptr) munmap(const_cast<unsigned char*>(this->data), this->size);
+		if (this->file >= 0) ::close(this->file);
+
+		this->file = -1;
+#endif
+
+		this->data = nullptr;
+		this->size = 0;
+	}
+
+	const unsigned char* MappedFile::getData() const {
+		return this->data;
+	}
+	size_t MappedFile::getSize() const {
+		return this->size;
+	}
+
+	bool MappedFile::isOpen() const {
+		return this->data != nullptr;
+	}
+}
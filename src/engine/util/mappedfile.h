@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+
+namespace Brainstorm {
+	// Read only memory mapping of a whole file, pages are loaded by the OS on first touch.
+	class MappedFile {
+	private:
+		const unsigned char* data;
+		size_t size;
+
+#ifdef _WIN32
+		void* file;
+		void* mapping;
+#else
+		int file;
+#endif
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const char* location);
+		void close();
+
+		const unsigned char* getData() const;
+		size_t getSize() const;
+
+		bool isOpen() const;
+	};
+}
@@ -0,0 +1,93 @@
+#include "pacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+static inline int64_t now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace Brainstorm {
+	FramePacer::FramePacer(float targetFrameRate, float spinMicroseconds) {
+		this->period = 0;
+		this->spin = static_cast<int64_t>(spinMicroseconds * 1000.0f);
+		this->overshoot = 0;
+
+		this->history = {};
+		this->cursor = 0;
+		this->count = 0;
+
+		this->setTargetFrameRate(targetFrameRate);
+
+		this->lastFrame = now();
+		this->deadline = this->lastFrame + this->period;
+	}
+
+	void FramePacer::setTargetFrameRate(float targetFrameRate) {
+		this->period = static_cast<int64_t>(1000000000.0 / std::max(targetFrameRate, 1.0f));
+	}
+	float FramePacer::getTargetFrameTime() const {
+		return static_cast<float>(this->period) / 1000000.0f;
+	}
+
+	void FramePacer::wait() {
+		int64_t current = now();
+		int64_t margin = std::max(this->spin, this->overshoot);
+
+		if (this->deadline - current > margin) {
+			int64_t target = this->deadline - margin;
+			std::this_thread::sleep_for(std::chrono::nanoseconds(target - current));
+
+			current = now();
+			this->overshoot = std::max(this->overshoot - this->overshoot / 64, current - target);
+		}
+		while (current < this->deadline) {
+			std::this_thread::yield();
+			current = now();
+		}
+
+		// Schedule from the deadline rather than from now so the rate does not drift,
+		// but resynchronize after a long stall instead of rushing frames to catch up.
+		this->deadline += this->period;
+		if (current - this->deadline > this->period) {
+			this->deadline = current + this->period;
+		}
+
+		this->history[this->cursor] = static_cast<float>(current - this->lastFrame) / 1000000.0f;
+		this->cursor = (this->cursor + 1) % HistorySize;
+		this->count = std::min(this->count + 1, HistorySize);
+
+		this->lastFrame = current;
+	}
+
+	FrameStats FramePacer::getStats() const {
+		FrameStats stats;
+		if (this->count == 0) return stats;
+
+		std::array<float, HistorySize> sorted;
+		float sum = 0.0f;
+
+		for (size_t i = 0; i < this->count; i++) {
+			sorted[i] = this->getFrameTime(i);
+			sum += sorted[i];
+		}
+		std::sort(sorted.begin(), sorted.begin() + this->count);
+
+		stats.average = sum / static_cast<float>(this->count);
+		stats.p50 = sorted[this->count / 2];
+		stats.p99 = sorted[std::min(this->count - 1, this->count * 99 / 100)];
+		stats.max = sorted[this->count - 1];
+		stats.jitter = stats.p99 - this->getTargetFrameTime();
+
+		return stats;
+	}
+
+	float FramePacer::getFrameTime(size_t index) const {
+		size_t start = this->count < HistorySize ? 0 : this->cursor;
+		return this->history[(start + index) % HistorySize];
+	}
+	size_t FramePacer::getFrameCount() const {
+		return this->count;
+	}
+}
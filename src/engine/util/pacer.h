@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+
+namespace Brainstorm {
+	struct FrameStats {
+		float average = 0.0f, p50 = 0.0f, p99 = 0.0f, max = 0.0f;
+		float jitter = 0.0f; // p99 distance from the target frame time, in milliseconds
+	};
+
+	// Caps the frame rate when vsync is off. Sleeps coarsely until shortly before the deadline and spins
+	// for the remainder, the spin window grows with the worst sleep overshoot seen so far.
+	// Input should be polled right after wait() returns so it is latched as late as possible.
+	class FramePacer {
+	public:
+		static const size_t HistorySize = 240;
+	private:
+		int64_t period, spin, overshoot;
+		int64_t deadline, lastFrame;
+
+		std::array<float, HistorySize> history;
+		size_t cursor, count;
+	public:
+		FramePacer(float targetFrameRate, float spinMicroseconds = 300.0f);
+
+		void setTargetFrameRate(float targetFrameRate);
+		float getTargetFrameTime() const;
+
+		void wait();
+
+		FrameStats getStats() const;
+
+		// Frame times in milliseconds, index 0 being the oldest recorded frame.
+		float getFrameTime(size_t index) const;
+		size_t getFrameCount() const;
+	};
+}
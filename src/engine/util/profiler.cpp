@@ -0,0 +1,175 @@
+#include "profiler.h"
+#include "../io/logger.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Brainstorm {
+	int64_t Profiler::now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+#ifdef BRAINSTORM_PROFILE
+	// Buffers outlive their threads so a capture can still be exported after a thread exits.
+	static std::mutex registryMutex;
+	static std::vector<std::unique_ptr<ProfileBuffer>> registry;
+
+	std::atomic<int64_t> Profiler::captureStart = 0;
+	std::atomic<int> Profiler::captureFrames = 0;
+	const char* Profiler::capturePath = nullptr;
+
+	void ProfileBuffer::push(const ProfileEvent& event) {
+		uint64_t index = this->head.load(std::memory_order_relaxed);
+		ProfileSlot& slot = this->slots[index % Capacity];
+
+		// Marked as being written first. The fields are released, whoever reads a new one also sees the mark.
+		slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+
+		slot.name.store(event.name, std::memory_order_release);
+		slot.start.store(event.start, std::memory_order_release);
+		slot.duration.store(event.duration, std::memory_order_release);
+		slot.depth.store(event.depth, std::memory_order_release);
+		slot.timeline.store(event.timeline, std::memory_order_release);
+
+		slot.sequence.store(index * 2 + 2, std::memory_order_release);
+		this->head.store(index + 1, std::memory_order_release);
+	}
+	bool ProfileBuffer::read(uint64_t index, ProfileEvent& event) const {
+		const ProfileSlot& slot = this->slots[index % Capacity];
+
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != index * 2 + 2) return false;
+
+		event.name = slot.name.load(std::memory_order_acquire);
+		event.start = slot.start.load(std::memory_order_acquire);
+		event.duration = slot.duration.load(std::memory_order_acquire);
+		event.depth = slot.depth.load(std::memory_order_acquire);
+		event.timeline = slot.timeline.load(std::memory_order_acquire);
+
+		// Unchanged after the copy, so the owner did not start on the slot in between.
+		return slot.sequence.load(std::memory_order_relaxed) == sequence;
+	}
+
+	ProfileBuffer& Profiler::getBuffer() {
+		thread_local ProfileBuffer* buffer = nullptr;
+
+		if (buffer == nullptr) {
+			std::lock_guard<std::mutex> lock(registryMutex);
+
+			registry.push_back(std::make_unique<ProfileBuffer>());
+			buffer = registry.back().get();
+			buffer->threadId = static_cast<uint32_t>(registry.size());
+		}
+
+		return *buffer;
+	}
+
+	void Profiler::setThreadName(const char* name) {
+		Profiler::getBuffer().threadName.store(name, std::memory_order_relaxed);
+	}
+	uint32_t Profiler::createTimeline(const char* name) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		// An empty buffer only carries the name, its events live in the buffers of the recording threads.
+		registry.push_back(std::make_unique<ProfileBuffer>());
+		registry.back()->threadId = static_cast<uint32_t>(registry.size());
+		registry.back()->threadName.store(name, std::memory_order_relaxed);
+
+		return registry.back()->threadId;
+	}
+
+	uint32_t Profiler::begin() {
+		return Profiler::getBuffer().depth++;
+	}
+	void Profiler::end(const char* name, int64_t start, uint32_t depth) {
+		ProfileBuffer& buffer = Profiler::getBuffer();
+
+		buffer.depth = depth;
+		buffer.push({ name, start, Profiler::now() - start, depth, 0 });
+	}
+
+	void Profiler::record(const char* name, int64_t start, int64_t duration, uint32_t timeline) {
+		Profiler::getBuffer().push({ name, start, duration, 0, timeline });
+	}
+
+	void Profiler::capture(int frames, const char* path) {
+		if (Profiler::isCapturing()) {
+			Logger::warn("Profiler is already capturing.");
+			return;
+		}
+
+		Profiler::capturePath = path;
+		Profiler::captureStart.store(Profiler::now(), std::memory_order_relaxed);
+		Profiler::captureFrames.store(frames, std::memory_order_release);
+
+		Logger::info("Profiler: capturing %d frames.", frames);
+	}
+	bool Profiler::isCapturing() {
+		return Profiler::captureFrames.load(std::memory_order_acquire) > 0;
+	}
+	void Profiler::frame() {
+		if (Profiler::captureFrames.load(std::memory_order_acquire) <= 0) return;
+
+		if (Profiler::captureFrames.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Profiler::exportCapture(Profiler::now());
+		}
+	}
+
+	void Profiler::exportCapture(int64_t end) {
+		std::ofstream file(Profiler::capturePath);
+
+		if (!file.is_open()) {
+			Logger::error("Profiler: could not open \"%s\" for writing.", Profiler::capturePath);
+			return;
+		}
+
+		int64_t start = Profiler::captureStart.load(std::memory_order_relaxed);
+		size_t exported = 0;
+
+		file << "{\"traceEvents\":[\n";
+		bool first = true;
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		for (const std::unique_ptr<ProfileBuffer>& buffer : registry) {
+			uint64_t head = buffer->head.load(std::memory_order_acquire);
+			uint64_t oldest = head > ProfileBuffer::Capacity ? head - ProfileBuffer::Capacity : 0;
+
+			const char* threadName = buffer->threadName.load(std::memory_order_relaxed);
+			if (threadName != nullptr) {
+				file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+					<< ",\"args\":{\"name\":\"" << threadName << "\"}}";
+				first = false;
+			}
+
+			// The owners keep recording, events they overwrite meanwhile are the oldest ones and are skipped.
+			for (uint64_t i = oldest; i < head; i++) {
+				ProfileEvent event;
+				if (!buffer->read(i, event)) continue;
+				if (event.start < start || event.start > end) continue;
+
+				uint32_t threadId = event.timeline != 0 ? event.timeline : buffer->threadId;
+
+				file << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+					<< ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+					<< ",\"dur\":" << static_cast<double>(event.duration) / 1000.0 << "}";
+
+				first = false;
+				exported++;
+			}
+		}
+
+		file << "\n]}\n";
+		file.close();
+
+		Logger::info("Profiler: wrote %zu events to \"%s\".", exported, Profiler::capturePath);
+	}
+
+	ProfileScope::ProfileScope(const char* name) : name(name), start(Profiler::now()), depth(Profiler::begin()) {}
+	ProfileScope::~ProfileScope() {
+		Profiler::end(this->name, this->start, this->depth);
+	}
+#endif
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+namespace Brainstorm {
+	struct ProfileEvent {
+		const char* name;
+		int64_t start, duration; // nanoseconds
+		uint32_t depth;
+		uint32_t timeline; // 0 for the recording thread itself
+	};
+
+	// One event of the ring behind a sequence lock: odd while the owner writes it, 2 * (index + 1) once event
+	// index is complete. The fields are atomics as well, a reader racing the owner gets a torn copy it throws
+	// away instead of undefined behavior.
+	struct ProfileSlot {
+		std::atomic<uint64_t> sequence = 0;
+
+		std::atomic<const char*> name = nullptr;
+		std::atomic<int64_t> start = 0, duration = 0;
+		std::atomic<uint32_t> depth = 0, timeline = 0;
+	};
+
+	// Single writer ring of finished zones, owned by one thread. Recording never takes a lock,
+	// exporting copies every slot it can read complete and skips the ones being overwritten.
+	struct ProfileBuffer {
+		static const size_t Capacity = 1 << 16;
+
+		std::array<ProfileSlot, Capacity> slots;
+		std::atomic<uint64_t> head = 0;
+
+		uint32_t depth = 0;
+		uint32_t threadId = 0;
+		std::atomic<const char*> threadName = nullptr;
+
+		void push(const ProfileEvent& event);
+		// Copies event index out of the ring, false if it was overwritten or is being written.
+		bool read(uint64_t index, ProfileEvent& event) const;
+	};
+
+	// Everything but now() is only defined with BRAINSTORM_PROFILE, go through the BS_PROFILE_ macros.
+	class Profiler {
+	private:
+		static std::atomic<int64_t> captureStart;
+		static std::atomic<int> captureFrames;
+		static const char* capturePath;
+
+		static ProfileBuffer& getBuffer();
+		static void exportCapture(int64_t end);
+	public:
+		static int64_t now();
+
+		static void setThreadName(const char* name);
+
+		// Named track that is not a thread, e.g. "GPU". Events are recorded into it with record().
+		static uint32_t createTimeline(const char* name);
+
+		static uint32_t begin();
+		static void end(const char* name, int64_t start, uint32_t depth);
+
+		static void record(const char* name, int64_t start, int64_t duration, uint32_t timeline);
+
+		// Records the next frames and writes them to a Chrome trace (chrome://tracing, Perfetto) when done.
+		static void capture(int frames, const char* path);
+		static bool isCapturing();
+		static void frame();
+	};
+
+	class ProfileScope {
+	private:
+		const char* name;
+		int64_t start;
+		uint32_t depth;
+	public:
+		ProfileScope(const char* name);
+		~ProfileScope();
+	};
+}
+
+#define BS_PROFILE_CONCAT_INNER(a, b) a##b
+#define BS_PROFILE_CONCAT(a, b) BS_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef BRAINSTORM_PROFILE
+#define BS_PROFILE_SCOPE(name) ::Brainstorm::ProfileScope BS_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define BS_PROFILE_THREAD(name) ::Brainstorm::Profiler::setThreadName(name)
+#define BS_PROFILE_FRAME() ::Brainstorm::Profiler::frame()
+#define BS_PROFILE_CAPTURE(frames, path) ::Brainstorm::Profiler::capture(frames, path)
+#else
+#define BS_PROFILE_SCOPE(name) ((void)0)
+#define BS_PROFILE_THREAD(name) ((void)0)
+#define BS_PROFILE_FRAME() ((void)0)
+#define BS_PROFILE_CAPTURE(frames, path) ((void)0)
+#endif
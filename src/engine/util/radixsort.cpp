@@ -0,0 +1,60 @@
+#include "radixsort.h"
+
+namespace Brainstorm {
+	void RadixSorter::reserve(size_t count) {
+		for (size_t i = 0; i < 2; i++) {
+			this->keys[i].reserve(count);
+			this->indices[i].reserve(count);
+		}
+	}
+
+	const std::vector<uint32_t>& RadixSorter::sort(const uint16_t* keys, size_t count) {
+		for (size_t i = 0; i < 2; i++) {
+			this->keys[i].resize(count);
+			this->indices[i].resize(count);
+		}
+
+		this->histograms = {};
+
+		// Both digit histograms in a single pass over the input.
+		for (size_t i = 0; i < count; i++) {
+			this->keys[0][i] = keys[i];
+			this->indices[0][i] = static_cast<uint32_t>(i);
+
+			this->histograms[0][keys[i] & 0xFF]++;
+			this->histograms[1][keys[i] >> 8]++;
+		}
+
+		size_t current = 0;
+		for (size_t pass = 0; pass < 2; pass++) {
+			std::array<uint32_t, 256>& histogram = this->histograms[pass];
+			unsigned shift = static_cast<unsigned>(pass * 8);
+
+			// Every key has the same digit, the pass would only copy.
+			if (count == 0 || histogram[(this->keys[current][0] >> shift) & 0xFF] == count) continue;
+
+			uint32_t offset = 0;
+			for (uint32_t& bucket : histogram) {
+				uint32_t size = bucket;
+				bucket = offset;
+				offset += size;
+			}
+
+			const std::vector<uint16_t>& sourceKeys = this->keys[current];
+			const std::vector<uint32_t>& sourceIndices = this->indices[current];
+			std::vector<uint16_t>& targetKeys = this->keys[1 - current];
+			std::vector<uint32_t>& targetIndices = this->indices[1 - current];
+
+			for (size_t i = 0; i < count; i++) {
+				uint32_t slot = histogram[(sourceKeys[i] >> shift) & 0xFF]++;
+
+				targetKeys[slot] = sourceKeys[i];
+				targetIndices[slot] = sourceIndices[i];
+			}
+
+			current = 1 - current;
+		}
+
+		return this->indices[current];
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace Brainstorm {
+	// Stable LSD radix sort of 16 bit keys, two 8 bit passes. Produces the order of the input
+	// instead of moving the caller's data, the scratch buffers are kept between calls so a
+	// sorter that lives across frames does not allocate once it has grown.
+	class RadixSorter {
+	private:
+		std::array<std::vector<uint16_t>, 2> keys;
+		std::array<std::vector<uint32_t>, 2> indices;
+		std::array<std::array<uint32_t, 256>, 2> histograms;
+	public:
+		void reserve(size_t count);
+
+		// Indices into keys in ascending key order, equal keys keep their input order.
+		// The returned vector is owned by the sorter and valid until the next sort.
+		const std::vector<uint32_t>& sort(const uint16_t* keys, size_t count);
+	};
+}
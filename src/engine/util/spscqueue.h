@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Brainstorm {
+	// Bounded FIFO between exactly one producer and one consumer thread, without locks. Each side only writes
+	// its own index, the other one reads it to see how far it may go.
+	template<typename T, size_t Capacity>
+	class SpscQueue {
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+	private:
+		std::array<T, Capacity> items;
+
+		alignas(64) std::atomic<size_t> head; // Next item to pop, written by the consumer
+		alignas(64) std::atomic<size_t> tail; // Next slot to push, written by the producer
+	public:
+		SpscQueue() : head(0), tail(0) {}
+
+		// Producer side, returns false when the queue is full.
+		bool push(const T& item) {
+			size_t tail = this->tail.load(std::memory_order_relaxed);
+			if (tail - this->head.load(std::memory_order_acquire) == Capacity) return false;
+
+			this->items[tail & (Capacity - 1)] = item;
+			this->tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer side, returns false when the queue is empty.
+		bool pop(T& item) {
+			size_t head = this->head.load(std::memory_order_relaxed);
+			if (head == this->tail.load(std::memory_order_acquire)) return false;
+
+			item = this->items[head & (Capacity - 1)];
+			this->head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Only a snapshot while the other side keeps running.
+		size_t size() const {
+			return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+		}
+	};
+}
@@ -35,4 +35,8 @@ namespace Brainstorm {
 	float Timer::getRealTime() const {
 		return this->realTime;
 	}
+
+	double Timer::now() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
 }
\ No newline at end of file
@@ -18,5 +18,8 @@ namespace Brainstorm {
 
 		float getTime() const;
 		float getRealTime() const;
+
+		// Monotonic seconds from an arbitrary origin, comparable between threads.
+		static double now();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <stdint.h>
+
+namespace Brainstorm {
+	// Latest value exchange between one writer and one reader thread, neither side ever waits. The writer fills
+	// its back buffer and publishes it, the reader swaps in whatever was published last. Values published while
+	// the reader was not looking are skipped, so the writer has to fill the whole buffer every time.
+	template<typename T>
+	class TripleBuffer {
+	private:
+		static const uint8_t Fresh = 4;
+
+		std::array<T, 3> buffers;
+
+		// Index of the buffer in between, with Fresh set while it holds a value the reader has not taken.
+		alignas(64) std::atomic<uint8_t> middle;
+
+		alignas(64) uint8_t back; // Writer only
+		alignas(64) uint8_t front; // Reader only
+	public:
+		TripleBuffer() : middle(1), back(0), front(2) {}
+
+		T& getWriteBuffer() {
+			return this->buffers[this->back];
+		}
+		void publish() {
+			this->back = this->middle.exchange(this->back | Fresh, std::memory_order_acq_rel) & ~Fresh;
+		}
+
+		// Takes the last published value if there is a new one, returns false otherwise.
+		bool update() {
+			if (!(this->middle.load(std::memory_order_relaxed) & Fresh)) return false;
+
+			this->front = this->middle.exchange(this->front, std::memory_order_acq_rel) & ~Fresh;
+			return true;
+		}
+		// Stays valid and unchanged until the next update().
+		const T& getReadBuffer() const {
+			return this->buffers[this->front];
+		}
+	};
+}
@@ -0,0 +1,170 @@
+#include "entitystore.h"
+#include "../common/movement.h"
+
+EntityStore::EntityStore() {
+    byNetworkId.fill(EntityHandle());
+}
+
+EntityHandle EntityStore::create(EntityKind kind, const glm::vec2 &position, float mass, const glm::vec4 &color) {
+    uint32_t index;
+    if(!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back(InvalidSlot);
+        generations.push_back(0);
+    }
+
+    uint32_t slot = static_cast<uint32_t>(positions.size());
+    slots[index] = slot;
+
+    positions.push_back(position);
+    points.push_back(mass);
+    radii.push_back(getCellRadius(mass));
+    kinds.push_back(kind);
+
+    colors.push_back(color);
+    skins.push_back(-1);
+    names.emplace_back();
+    labels.emplace_back();
+    networkIds.push_back(0);
+
+    owners.push_back(index);
+
+    return {index, generations[index]};
+}
+
+void EntityStore::remove(EntityHandle handle) {
+    uint32_t slot = getSlot(handle);
+    if(slot != InvalidSlot) {
+        removeAt(slot);
+    }
+}
+
+void EntityStore::removeAt(uint32_t slot) {
+    uint32_t index = owners[slot];
+
+    if(kinds[slot] == ENTITY_REMOTE && byNetworkId[networkIds[slot]] == EntityHandle{index, generations[index]}) {
+        byNetworkId[networkIds[slot]] = EntityHandle();
+    }
+
+    uint32_t last = static_cast<uint32_t>(positions.size() - 1);
+    if(slot != last) {
+        positions[slot] = positions[last];
+        points[slot] = points[last];
+        radii[slot] = radii[last];
+        kinds[slot] = kinds[last];
+
+        colors[slot] = colors[last];
+        skins[slot] = skins[last];
+        names[slot] = std::move(names[last]);
+        labels[slot] = std::move(labels[last]);
+        networkIds[slot] = networkIds[last];
+
+        owners[slot] = owners[last];
+        slots[owners[slot]] = slot;
+    }
+
+    positions.pop_back();
+    points.pop_back();
+    radii.pop_back();
+    kinds.pop_back();
+
+    colors.pop_back();
+    skins.pop_back();
+    names.pop_back();
+    labels.pop_back();
+    networkIds.pop_back();
+
+    owners.pop_back();
+
+    slots[index] = InvalidSlot;
+    generations[index]++;
+    freeIndices.push_back(index);
+}
+
+void EntityStore::clear() {
+    while(!positions.empty()) {
+        removeAt(static_cast<uint32_t>(positions.size() - 1));
+    }
+}
+
+bool EntityStore::isAlive(EntityHandle handle) const {
+    return handle.index < slots.size() && generations[handle.index] == handle.generation && slots[handle.index] != InvalidSlot;
+}
+
+uint32_t EntityStore::getSlot(EntityHandle handle) const {
+    return isAlive(handle) ? slots[handle.index] : InvalidSlot;
+}
+
+EntityHandle EntityStore::getHandle(uint32_t slot) const {
+    uint32_t index = owners[slot];
+    return {index, generations[index]};
+}
+
+void EntityStore::bindNetworkId(uint8_t id, EntityHandle handle) {
+    uint32_t slot = getSlot(handle);
+    if(slot == InvalidSlot) return;
+
+    networkIds[slot] = id;
+    byNetworkId[id] = handle;
+}
+
+EntityHandle EntityStore::findNetworkId(uint8_t id) const {
+    return byNetworkId[id];
+}
+
+void EntityStore::setPosition(uint32_t slot, const glm::vec2 &position) {
+    positions[slot] = position;
+}
+
+void EntityStore::setPoints(uint32_t slot, float mass) {
+    points[slot] = mass;
+    radii[slot] = getCellRadius(mass);
+}
+
+void EntityStore::setSkin(uint32_t slot, int32_t skin) {
+    skins[slot] = skin;
+}
+
+void EntityStore::setName(uint32_t slot, std::string_view name) {
+    names[slot] = name;
+    labels[slot].named = false;
+}
+
+size_t EntityStore::size() const {
+    return positions.size();
+}
+
+const std::vector<glm::vec2> &EntityStore::getPositions() const {
+    return positions;
+}
+
+const std::vector<float> &EntityStore::getPoints() const {
+    return points;
+}
+
+const std::vector<float> &EntityStore::getRadii() const {
+    return radii;
+}
+
+const std::vector<EntityKind> &EntityStore::getKinds() const {
+    return kinds;
+}
+
+const glm::vec4 &EntityStore::getColor(uint32_t slot) const {
+    return colors[slot];
+}
+
+int32_t EntityStore::getSkin(uint32_t slot) const {
+    return skins[slot];
+}
+
+const std::string &EntityStore::getName(uint32_t slot) const {
+    return names[slot];
+}
+
+EntityLabel &EntityStore::getLabel(uint32_t slot) {
+    return labels[slot];
+}
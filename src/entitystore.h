@@ -0,0 +1,99 @@
+#pragma once
+#include "engine/graphics/font.h"
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum EntityKind : uint8_t {
+    ENTITY_FOOD,
+    ENTITY_REMOTE, // Another player, updated from the snapshots
+    ENTITY_PLAYER  // A cell of the local player
+};
+
+// Refers to an entity for as long as it lives. The generation tells a removed entity apart from
+// the one that reuses its index later, a stale handle simply resolves to no slot.
+struct EntityHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle &other) const = default;
+};
+
+// Name and mass text of an entity, shaped again only when they change.
+struct EntityLabel {
+    int32_t mass = -1; // Whole mass the text was shaped for, -1 before the first time
+    bool named = false; // The name is shaped
+    Brainstorm::ShapedText name, massText;
+};
+
+// The client world. Entities are packed into slots, slot i of every array is the same entity, and a removal
+// moves the last entity into the freed slot, so the per frame passes read contiguous memory without holes.
+// What those passes read (position, mass, radius, kind) is kept apart from what only drawing and the
+// leaderboard need (color, skin, name, label). Slots change on removal, handles are what to hold on to.
+class EntityStore {
+public:
+    static constexpr uint32_t InvalidSlot = UINT32_MAX;
+private:
+    // Hot
+    std::vector<glm::vec2> positions;
+    std::vector<float> points, radii;
+    std::vector<EntityKind> kinds;
+
+    // Cold
+    std::vector<glm::vec4> colors;
+    std::vector<int32_t> skins; // Skin layer, -1 draws a procedural circle
+    std::vector<std::string> names;
+    std::vector<EntityLabel> labels;
+    std::vector<uint8_t> networkIds;
+
+    // Handle index of every slot, to fix the moved entity up on removal.
+    std::vector<uint32_t> owners;
+
+    // Slot and generation of every handle index, freed indices are reused.
+    std::vector<uint32_t> slots, generations;
+    std::vector<uint32_t> freeIndices;
+
+    // Remote players by their network id, so a snapshot entity finds its slot without a search.
+    std::array<EntityHandle, 256> byNetworkId;
+public:
+    EntityStore();
+
+    EntityHandle create(EntityKind kind, const glm::vec2 &position, float points, const glm::vec4 &color);
+
+    // Swaps the last entity into the slot, the handle and every copy of it become stale. No-op on stale handles.
+    void remove(EntityHandle handle);
+    // While walking the slots, go from the back: the entity moved into the slot has been visited already.
+    void removeAt(uint32_t slot);
+
+    void clear();
+
+    bool isAlive(EntityHandle handle) const;
+    uint32_t getSlot(EntityHandle handle) const;
+    EntityHandle getHandle(uint32_t slot) const;
+
+    void bindNetworkId(uint8_t id, EntityHandle handle);
+    EntityHandle findNetworkId(uint8_t id) const;
+
+    void setPosition(uint32_t slot, const glm::vec2 &position);
+    // Keeps the radius in step.
+    void setPoints(uint32_t slot, float points);
+    void setSkin(uint32_t slot, int32_t skin);
+    void setName(uint32_t slot, std::string_view name);
+
+    size_t size() const;
+
+    const std::vector<glm::vec2> &getPositions() const;
+    const std::vector<float> &getPoints() const;
+    const std::vector<float> &getRadii() const;
+    const std::vector<EntityKind> &getKinds() const;
+
+    const glm::vec4 &getColor(uint32_t slot) const;
+    int32_t getSkin(uint32_t slot) const;
+    const std::string &getName(uint32_t slot) const;
+    EntityLabel &getLabel(uint32_t slot);
+};
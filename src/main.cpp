@@ -1,272 +1,373 @@
 #include "engine/engine.h"
+#include "renderer.h"
+#include "clientcore.h"
+#include "entitystore.h"
 #include <enet/enet.h>
 #include <vector>
 #include <bit>
 #include <iostream>
+#include <string>
 #include <cassert>
+#include <charconv>
+#include <cstdlib>
 #include <thread>
 
-void SendPacket(const char *data, size_t s, ENetPeer *to) {
-    ENetPacket *packet = enet_packet_create(data, s, ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(to, 0, packet);
-}
+// The local player steers with the mouse, relative to the center of the window.
+class MouseInput : public InputSource {
+public:
+    glm::vec2 getPointer() override {
+        float mouseX = (BS::Window::getMouseX() / BS::Window::getWidth()) * 2.0f - 1.0f;
+        float mouseY = (BS::Window::getMouseY() / BS::Window::getHeight()) * 2.0f - 1.0f;
+
+        return glm::vec2(mouseX * BS::Window::getAspect(), -mouseY);
+    }
+};
 
-struct Ball {
-    glm::vec2 pos;
-    double points;
-    glm::vec3 color;
-    glm::vec2 velocity;
-    bool isPlayer;
-    bool isDead = false;
-    uint8_t ID = 0;
+// Stable per player, spread around the hue circle by the golden ratio.
+glm::vec3 getPlayerColor(uint8_t id) {
+    return 0.5f + 0.4f * glm::cos(6.2831853f * (id * 0.618034f + glm::vec3(0.0f, 0.33f, 0.67f)));
+}
 
+// Shapes the label of an entity again only when the whole mass it shows or its name changed.
+const EntityLabel &updateLabel(EntityStore &world, BS::Font &font, uint32_t slot) {
+    EntityLabel &label = world.getLabel(slot);
 
-    Ball(glm::vec2 position, double points, glm::vec3 color): pos(position), points(points),  color(color) {};
-    Ball(glm::vec2 position, double points, glm::vec3 color, int ID): pos(position), points(points),  color(color), ID(ID) {};
+    int32_t mass = static_cast<int32_t>(world.getPoints()[slot]);
+    if(label.mass != mass) {
+        char digits[16];
+        char *end = std::to_chars(digits, digits + sizeof(digits), mass).ptr;
 
-    float getRadius() {
-        return static_cast<float>(points) * 0.004;
+        font.layout(std::string_view(digits, end - digits), label.massText);
+        label.mass = mass;
     }
 
-    bool checkCollision(Ball *second) {
-        if (glm::distance(pos, second->pos) - glm::max(this->getRadius(), second->getRadius()) > 0) {
-            return false;
-        }
-        return true;
+    if(!label.named) {
+        font.layout(world.getName(slot), label.name);
+        label.named = true;
     }
-    
 
-    void update(BS::Timer time) {
-        float mouseX = (BS::Window::getMouseX() / BS::Window::getWidth()) * 2.0f - 1.0f;
-        float mouseY = (BS::Window::getMouseY() / BS::Window::getHeight()) * 2.0f - 1.0f;
-    
-        mouseY *= -1;
-    
-        mouseX *= BS::Window::getAspect();
-        
-        float mouseRadius = 0.1;
-
-        velocity = glm::vec2(mouseX, mouseY) / mouseRadius;
-        
-        float length = glm::length(velocity);
-
-        if (length > 1 - glm::max(0.5f, this->getRadius())) {
-            velocity /= length;
+    return label;
+}
+
+// Per second rates of the traffic counters for the overlay, taken over the last second.
+struct TrafficRates {
+    double time = 0.0;
+    std::array<std::array<TrafficStats, TRAFFIC_KIND_COUNT>, 2> last = {}, rates = {};
+
+    void update(const NetStats &stats, double now) {
+        if(now - time < 1.0) return;
+
+        for(int direction = 0; direction < 2; direction++) {
+            for(int kind = 0; kind < TRAFFIC_KIND_COUNT; kind++) {
+                TrafficStats current = stats.getTraffic(static_cast<TrafficDirection>(direction), static_cast<TrafficKind>(kind));
+                TrafficStats &previous = last[direction][kind];
+
+                rates[direction][kind].packets = static_cast<uint64_t>((current.packets - previous.packets) / (now - time));
+                rates[direction][kind].bytes = static_cast<uint64_t>((current.bytes - previous.bytes) / (now - time));
+                previous = current;
+            }
         }
 
-        pos += velocity * time.getDelta();
+        time = now;
     }
 };
 
-struct Data {
-    uint8_t ID;
-    glm::vec2 pos;
-};
+int main(int argc, char **argv) {
+    // The local server by default, NetSim's port to play over a simulated bad link.
+    std::string host = "localhost";
+    int port = 25566;
 
-void Networking(std::vector<Ball> &players ,std::vector<Ball> &balls) {
-    ENetHost *client = nullptr;
-	ENetPeer *server = nullptr;
-
-	client = enet_host_create(NULL,
-		1,
-		0,
-		0,
-		0);
-
-	if (client == NULL)
-	{
-		std::cout << "An error occurred while trying to create an ENet client host.\n";
-		return;
-	}
-
-	ENetAddress address = {};
-	//enet_address_set_host(&address, "127.0.0.1");
-	enet_address_set_host(&address, "localhost");
-	address.port = 25566;
-
-    bool firstPacket = true;
-
-	server = enet_host_connect(client, &address, 0, 0);
-
-	if (server == nullptr)
-	{
-		std::cout << "Wasn't able to initialize connection\n";
-		enet_host_destroy(client);
-	}
-	else
-	{
-		ENetEvent event = {};
-		if (enet_host_service(client, &event, 15000) > 0 &&
-			event.type == ENET_EVENT_TYPE_CONNECT && BS::Window::isRunning())
-		{
-			std::cout << "Got a connection!\n";
-
-			while (BS::Window::isRunning()) {
-				ENetEvent event;
-
-				while (enet_host_service(client, &event, 50) > 0) {
-					switch (event.type)
-					{
-					case ENET_EVENT_TYPE_CONNECT:
-					break;
-
-					case ENET_EVENT_TYPE_RECEIVE:
-                    if(!firstPacket) {
-                        
-                        std::vector<Data> bloba;
-                        std::stringstream aboba{(char*)event.packet->data};
-
-                        while(aboba) {
-                            bloba.push_back({});
-                            aboba >> bloba.back().ID;
-                            aboba >> bloba.back().pos.x;
-                            aboba >> bloba.back().pos.y;
-                        }
-
-                        enet_packet_destroy(event.packet);
-                    } else {
-                        for(Ball &ball : players) {
-                            ball.ID = std::stoi((char*)event.packet->data);
-                        }
-                        
-                        enet_packet_destroy(event.packet);
-                        firstPacket = !firstPacket;
-                    }
-                    
-					break;
-
-					case ENET_EVENT_TYPE_DISCONNECT:
-					std::cout << "Server Disconected\n";
-                    firstPacket = !firstPacket;
-					break;
-					}
-				}
-
-                std::string ballPos = "";
-
-                for(Ball &ball : players) {
-                    ballPos.append(std::to_string(ball.ID) + " " + std::to_string(ball.pos.x) + " " + std::to_string(ball.pos.y));
-                }
-                SendPacket(ballPos.c_str(), ballPos.size() + 1, server);
-			}
-		}
-		else
-		{
-			std::cout << "Wasn't able to connect\n";
-		}
-
-		enet_peer_reset(server);
-		enet_host_destroy(client);
-	}
-}
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+
+        if(arg == "--host") {
+            host = argv[i + 1];
+        } else if(arg == "--port") {
+            port = std::atoi(argv[i + 1]);
+        }
+    }
 
-int main() {
     BS::Window::create(1920, 1080, "Agar");
     glfwSwapInterval( 0 );
 
-    std::vector<Ball> balls = {};
+    // Food, other players and the local cells, packed for the per frame passes.
+    EntityStore world;
 
-    std::vector<Ball> player_balls = {Ball(glm::vec2(0, 0), 20, glm::vec3(0.7, 0.0 , 0.0))};
-
-    BS::Mesh square = BS::Mesh(BS::VertexBuffer({0,0,1,0,1,1,0,1}, 2), {}, GL_TRIANGLE_FAN);
-    BS::Mesh background = BS::Mesh(BS::VertexBuffer({-1000,-1000,1000,-1000,1000,1000,-1000,1000}, 2), {}, GL_TRIANGLE_FAN);
+    std::vector<EntityHandle> playerCells = {world.create(ENTITY_PLAYER, glm::vec2(0, 0), 20, glm::vec4(0.7, 0.0, 0.0, 1.0))};
+    world.setName(world.getSlot(playerCells[0]), "Player");
 
     float zoom = 0.3;
 
-    BS::ShaderProgram worldShader = BS::ShaderProgram("./assets/shaders/world.vert", "./assets/shaders/world.frag", nullptr);
-
-    GLuint ballTexture = BS::Texture::loadFromFile("./assets/textures/Ball.png", GL_LINEAR, GL_REPEAT);
-    GLuint backGround = BS::Texture::loadFromFile("./assets/textures/BackGround.png", GL_NEAREST, GL_REPEAT);
+    WorldRenderer renderer;
+    BS::Font &font = renderer.getFont();
 
     BS::Timer time;
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glm::vec2 cameraPosition;
+
+    if(enet_initialize() != 0) {
+        std::cout << "An error occurred while initializing ENet.\n";
+    }
 
-    glm::vec2 ball_direction;
+    // Inputs are sent at this rate, the ones of the frames in between are batched.
+    const float InputRate = 60.0f;
 
-    glm::vec2 cameraPosition;
+    // Networking, world state and prediction. The window only feeds it the mouse and draws what it knows.
+    ClientCore core(host, static_cast<uint16_t>(port), InputRate);
+    MouseInput mouse;
+
+    PlayerState spawn;
+    spawn.count = 1;
+    uint32_t spawnSlot = world.getSlot(playerCells[0]);
+    spawn.cells[0] = {world.getPositions()[spawnSlot], world.getPoints()[spawnSlot]};
+    core.spawn(spawn);
+
+    core.start();
+
+    // F4 shows the network stats.
+    TrafficRates trafficRates;
+    bool showNetStats = false;
+    std::vector<std::string> netLines;
 
-    std::thread networking(Networking, std::ref(player_balls), std::ref(balls));
+    // Remote players present in the current sample, the others are removed.
+    std::array<bool, 256> sampled;
 
-    int fps = 0;
+    // Vsync is off, the pacer keeps the frame rate steady without spinning a whole core.
+    BS::FramePacer pacer(144.0f);
+    renderer.setTargetFrameTime(pacer.getTargetFrameTime());
 
-    double fpstimer;
+    // Bigger cells are drawn over smaller ones, the sorter and its keys are reused every frame.
+    BS::RadixSorter drawOrder;
+    std::vector<uint16_t> drawKeys;
+
+    std::vector<uint32_t> ranking;
+    std::vector<std::string> leaderboard;
+
+    // Eat effects of the current frame, simulated on the GPU.
+    std::vector<BS::ParticleBurst> bursts;
+
+    // From here on the GL context belongs to the render thread, this thread only simulates and records.
+    BS::RenderThread renderThread;
+    renderThread.start([&renderer](const BS::FramePacket &packet) { renderer.render(packet); });
+
+    BS_PROFILE_THREAD("Game");
 
     while(BS::Window::isRunning()) {
+        BS_PROFILE_FRAME();
+
+        {
+            BS_PROFILE_SCOPE("Pace");
+            pacer.wait();
+        }
+
+        // Input is latched right after the pacer wakes up, as close to submission as possible.
         BS::Window::pollEvents();
-        worldShader.use();
         time.update();
 
-        fps ++;
+        // F2 writes a trace of the next frames, open it in chrome://tracing or Perfetto.
+        if(BS::Window::isKeyJustPressed(BS::KeyCode::F2)) {
+            BS_PROFILE_CAPTURE(120, "profile.json");
+        }
+
+        if(BS::Window::isKeyJustPressed(BS::KeyCode::F4)) {
+            showNetStats = !showNetStats;
+        }
+
+        // T switches the local cells between the procedural and the textured path, to compare fragment cost.
+        if(BS::Window::isKeyJustPressed(BS::KeyCode::T)) {
+            for(EntityHandle cell : playerCells) {
+                uint32_t slot = world.getSlot(cell);
+                world.setSkin(slot, world.getSkin(slot) < 0 ? renderer.getDefaultSkin() : -1);
+            }
+        }
+
+        BS_PROFILE_SCOPE("Tick");
+
+        bursts.clear();
+
+        core.update(mouse, time.getDelta(), BS::Timer::now());
+
+        const std::vector<glm::vec2> &positions = world.getPositions();
+        const std::vector<float> &points = world.getPoints();
+        const std::vector<float> &radii = world.getRadii();
+        const std::vector<EntityKind> &kinds = world.getKinds();
+
+        for(size_t i = 0; i < playerCells.size(); i++) {
+            uint32_t slot = world.getSlot(playerCells[i]);
 
-        fpstimer += time.getDelta();
+            world.setPosition(slot, core.getPrediction().getDisplayPosition(i));
 
-        if(fpstimer >= 1) {
-            printf("%i\n", fps);
-            fpstimer = 0;
-            fps = 0;
+            zoom = glm::max(glm::min(20.0f, 1 / radii[slot] * 0.5f - 4), 1.0f);
+            cameraPosition = positions[slot];
         }
 
-        BS::Texture::use(backGround);
-        
-        worldShader.setVector2("position", glm::vec2(0, 0));
-        worldShader.setFloat("size", 1);
-        worldShader.setVector4("hue", glm::vec4(0.7, 0.7, 0.7, 1.0));
-
-        background.render();
-
-        worldShader.setFloat("aspect", BS::Window::getAspect());
-        
-        BS::Texture::use(ballTexture);
-
-        for(auto &ball : balls) {
-            worldShader.setVector4("hue", glm::vec4(ball.color, 1.0));
-            worldShader.setVector2("position", glm::vec2(ball.pos.x - static_cast<float>(ball.getRadius()), ball.pos.y - static_cast<float>(ball.getRadius())));
-            worldShader.setVector2("cameraPosition", cameraPosition);
-            worldShader.setFloat("size", ball.getRadius() * 2);
-
-            square.render();
-            
-            for(Ball &player_ball : player_balls) {
-                if(player_ball.checkCollision(&ball)) {
-                    if (player_ball.points > ball.points) {
-                        player_ball.points += ball.points;
-                        ball.isDead = true;
-                        break;
-                    } else if (player_ball.points < ball.points) {
-                        
-                    } else {}
-                }
+        // From the back, so the entity a removal swaps into the slot has been checked already.
+        for(uint32_t slot = static_cast<uint32_t>(world.size()); slot-- > 0;) {
+            if(kinds[slot] != ENTITY_FOOD) continue;
+
+            for(EntityHandle cell : playerCells) {
+                uint32_t eater = world.getSlot(cell);
+
+                if(points[eater] <= points[slot]) continue;
+                if(glm::distance(positions[eater], positions[slot]) > glm::max(radii[eater], radii[slot])) continue;
+
+                float radius = radii[slot];
+                glm::vec2 velocity = getCellVelocity(core.getPointer(), radii[eater]);
+                bursts.push_back({
+                    positions[slot], velocity * 0.5f, world.getColor(slot),
+                    radius * 4.0f + 0.2f, 0.6f, radius * 0.2f + 0.02f, 16 + static_cast<uint32_t>(glm::min(points[slot], 200.0f))
+                });
+
+                world.setPoints(eater, points[eater] + points[slot]);
+                world.removeAt(slot);
+                break;
+            }
+        }
+
+        for(size_t i = 0; i < playerCells.size(); i++) {
+            core.setPoints(i, points[world.getSlot(playerCells[i])]);
+        }
+
+        // Remote players are drawn a little in the past, between the two snapshots around the render time.
+        sampled.fill(false);
+        for(const EntityState &entity : core.sampleRemotes(BS::Timer::now())) {
+            EntityHandle handle = world.findNetworkId(entity.id);
+
+            if(!world.isAlive(handle)) {
+                handle = world.create(ENTITY_REMOTE, entity.position, entity.points, glm::vec4(getPlayerColor(entity.id), 1.0f));
+                char name[16];
+                snprintf(name, sizeof(name), "Player %u", static_cast<unsigned>(entity.id));
+                world.setName(world.getSlot(handle), name);
+                world.bindNetworkId(entity.id, handle);
+            }
+
+            uint32_t slot = world.getSlot(handle);
+            world.setPosition(slot, entity.position);
+            world.setPoints(slot, entity.points);
+
+            sampled[entity.id] = true;
+        }
+        for(size_t id = 0; id < sampled.size(); id++) {
+            if(!sampled[id]) {
+                world.remove(world.findNetworkId(static_cast<uint8_t>(id)));
+            }
+        }
+
+        BS::FramePacket &packet = renderThread.begin();
+
+        packet.view.cameraPosition = cameraPosition;
+        packet.view.zoom = zoom;
+        packet.view.aspect = BS::Window::getAspect();
+        packet.view.framebufferSize = BS::Window::getFrameBufferSize();
+
+        packet.draw(PASS_GRID, 0, 0);
+
+        uint32_t cellOffset = static_cast<uint32_t>(packet.instances.size());
+
+        drawKeys.clear();
+        for(float mass : points) {
+            drawKeys.push_back(WorldRenderer::getDrawKey(mass));
+        }
+
+        // Stable, equal masses keep their slot order.
+        for(uint32_t slot : drawOrder.sort(drawKeys.data(), drawKeys.size())) {
+            const glm::vec2 &position = positions[slot];
+            float radius = radii[slot];
+
+            WorldRenderer::pushCell(packet, position, radius, world.getColor(slot), world.getSkin(slot));
+
+            // Labels follow their cell in the stream, so a bigger cell covers them together.
+            if(radius * zoom < 0.05f) continue;
+
+            const EntityLabel &label = updateLabel(world, font, slot);
+
+            if(world.getName(slot).empty()) {
+                WorldRenderer::pushText(packet, font, label.massText, position, radius * 0.4f, glm::vec4(1.0f));
+            } else {
+                WorldRenderer::pushText(packet, font, label.name, position + glm::vec2(0.0f, radius * 0.1f), radius * 0.4f, glm::vec4(1.0f));
+                WorldRenderer::pushText(packet, font, label.massText, position - glm::vec2(0.0f, radius * 0.3f), radius * 0.25f, glm::vec4(1.0f));
+            }
+        }
+
+        packet.draw(PASS_CELLS, cellOffset, static_cast<uint32_t>((packet.instances.size() - cellOffset) / WorldRenderer::CellFloats));
+
+        WorldRenderer::pushParticles(packet, bursts);
+
+        WorldRenderer::pushFrameGraph(packet, font, pacer, glm::vec2(10, 10));
+
+        if(showNetStats) {
+            double now = BS::Timer::now();
+            const NetStats &netStats = core.getStats();
+            const SnapshotBuffer &snapshots = core.getSnapshots();
+
+            trafficRates.update(netStats, now);
+
+            LinkStats link = netStats.getLink();
+            char line[128];
+
+            netLines.clear();
+
+            snprintf(line, sizeof(line), "rtt %u ms +-%u  loss %.1f%%  throttle %.0f%%", link.roundTripTime, link.roundTripTimeVariance, link.packetLoss * 100.0f, link.throttle * 100.0f);
+            netLines.push_back(line);
+            snprintf(line, sizeof(line), "snapshots: jitter %.1f ms  delay %.0f ms  depth %zu", snapshots.getJitter() * 1000.0, snapshots.getDelay() * 1000.0, snapshots.getDepth(now));
+            netLines.push_back(line);
+            snprintf(line, sizeof(line), "prediction: %zu inputs pending", core.getPrediction().getPendingCount());
+            netLines.push_back(line);
+
+            for(int kind = 0; kind < TRAFFIC_KIND_COUNT; kind++) {
+                const TrafficStats &in = trafficRates.rates[TRAFFIC_RECEIVED][kind];
+                const TrafficStats &out = trafficRates.rates[TRAFFIC_SENT][kind];
+                if(in.packets == 0 && out.packets == 0) continue;
+
+                snprintf(line, sizeof(line), "%s: in %llu/s %.1f kB/s  out %llu/s %.1f kB/s", NetStats::getKindName(static_cast<TrafficKind>(kind)),
+                         static_cast<unsigned long long>(in.packets), in.bytes / 1000.0, static_cast<unsigned long long>(out.packets), out.bytes / 1000.0);
+                netLines.push_back(line);
+            }
+
+            // Below the frame graph.
+            WorldRenderer::pushTextPanel(packet, font, netLines, glm::vec2(10, 140), 16.0f);
+        }
+
+        uint64_t changedRows = core.takeMinimapRows();
+        if(changedRows != 0) {
+            WorldRenderer::pushMinimapRows(packet, core.getMinimap(), changedRows);
+        }
+
+        const float MinimapSize = 200.0f, MinimapMargin = 10.0f;
+        WorldRenderer::pushMinimap(packet, glm::vec2(packet.view.framebufferSize) - MinimapSize - MinimapMargin, MinimapSize);
+
+        ranking.clear();
+        for(uint32_t slot = 0; slot < world.size(); slot++) {
+            if(kinds[slot] != ENTITY_FOOD) {
+                ranking.push_back(slot);
             }
         }
-        balls.erase(std::remove_if(balls.begin(), 
-                              balls.end(),
-                              [](auto ball) { return ball.isDead; }),
-                balls.end());
-
-        for(Ball &ball : player_balls) {
-            ball.update(time);
-            worldShader.setVector4("hue", glm::vec4(ball.color, 1.0));
-            worldShader.setVector2("position", glm::vec2(ball.pos.x - static_cast<float>(ball.getRadius()), ball.pos.y - static_cast<float>(ball.getRadius())));
-            worldShader.setFloat("size", ball.getRadius() * 2);
-            worldShader.setFloat("zoom", glm::max(glm::min(20.0 ,1 / ball.getRadius() * 0.5 - 4), 1.0));
-            cameraPosition = glm::vec2(ball.pos.x, ball.pos.y);
-            worldShader.setVector2("cameraPosition", cameraPosition);
-            
-            square.render();
+        std::sort(ranking.begin(), ranking.end(), [&points](uint32_t a, uint32_t b) { return points[a] > points[b]; });
+
+        // The lines are kept and overwritten in place, their storage is reused from frame to frame.
+        leaderboard.resize(ranking.size());
+        for(size_t i = 0; i < ranking.size(); i++) {
+            char line[64];
+            snprintf(line, sizeof(line), "%zu. %s %d", i + 1, world.getName(ranking[i]).c_str(), static_cast<int>(points[ranking[i]]));
+            leaderboard[i] = line;
         }
+        WorldRenderer::pushLeaderboard(packet, font, leaderboard);
 
-        BS::Window::swapBuffers();
+        // F3 records this frame for RenderBench to replay.
+        if(BS::Window::isKeyJustPressed(BS::KeyCode::F3)) {
+            packet.save("scene.bin");
+        }
+
+        renderThread.submit();
     }
 
-    square.destroy();
-    worldShader.destroy();
-    BS::Texture::destroy(ballTexture);
+    renderThread.stop();
+    renderer.destroy();
 
-    networking.join();
+    core.stop();
+    enet_deinitialize();
 
     BS::Window::close();
 
     return 0;
-}
\ No newline at end of file
+}
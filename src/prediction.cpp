@@ -0,0 +1,77 @@
+#include "prediction.h"
+
+Prediction::Prediction() : nextSequence(1), acknowledged(0) {
+    error.fill(glm::vec2(0.0f));
+}
+
+void Prediction::reset(const PlayerState &state) {
+    this->state = state;
+    error.fill(glm::vec2(0.0f));
+
+    // Sequences keep counting, the server ignores anything it has already seen.
+    acknowledged = nextSequence - 1;
+}
+
+MoveInput Prediction::record(const glm::vec2 &pointer, float delta) {
+    MoveInput input = {nextSequence++, pointer, glm::clamp(delta, 0.0f, MaxInputDelta)};
+
+    inputs[input.sequence % Capacity] = input;
+    applyInput(state, input);
+
+    return input;
+}
+
+void Prediction::reconcile(const PlayerState &authoritative, uint32_t acknowledged) {
+    // Sequenced channel, but an old snapshot must never undo newer acknowledgements.
+    if(acknowledged < this->acknowledged || acknowledged >= nextSequence) return;
+    this->acknowledged = acknowledged;
+
+    PlayerState previous = state;
+
+    state.count = authoritative.count;
+    for(size_t i = 0; i < state.count; i++) {
+        state.cells[i].position = authoritative.cells[i].position;
+        state.cells[i].points = i < previous.count ? previous.cells[i].points : authoritative.cells[i].points;
+    }
+
+    // Inputs that fell out of the ring are lost, the next acknowledgement covers them.
+    uint32_t first = glm::max(acknowledged + 1, nextSequence > Capacity ? nextSequence - static_cast<uint32_t>(Capacity) : 0u);
+    for(uint32_t sequence = first; sequence < nextSequence; sequence++) {
+        applyInput(state, inputs[sequence % Capacity]);
+    }
+
+    // Far off corrections, e.g. after a respawn, are applied at once instead of sliding across the map.
+    const float SnapDistance = 0.5f;
+
+    for(size_t i = 0; i < state.count; i++) {
+        glm::vec2 before = i < previous.count ? previous.cells[i].position + error[i] : state.cells[i].position;
+        error[i] = before - state.cells[i].position;
+
+        if(glm::length(error[i]) > SnapDistance) error[i] = glm::vec2(0.0f);
+    }
+}
+
+void Prediction::update(float delta) {
+    // About 100 ms to fade out a correction.
+    float decay = glm::exp(-delta * 10.0f);
+
+    for(size_t i = 0; i < state.count; i++) {
+        error[i] *= decay;
+    }
+}
+
+void Prediction::setPoints(size_t cell, float points) {
+    if(cell < state.count) state.cells[cell].points = points;
+}
+
+const PlayerState &Prediction::getState() const {
+    return state;
+}
+
+glm::vec2 Prediction::getDisplayPosition(size_t cell) const {
+    return state.cells[cell].position + error[cell];
+}
+
+size_t Prediction::getPendingCount() const {
+    return nextSequence - 1 - acknowledged;
+}
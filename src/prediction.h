@@ -0,0 +1,44 @@
+#pragma once
+#include "../common/movement.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Client side prediction of the local player. Inputs are applied as soon as they are made and kept until the
+// server acknowledges them; every authoritative state rewinds to it and replays the inputs still in flight.
+// The difference to the previous prediction is kept as an offset that fades out, so corrections never pop.
+//
+// Mass stays with the client until eating moves to the server, reconciliation only corrects positions.
+class Prediction {
+public:
+    static const size_t Capacity = 128;
+private:
+    std::array<MoveInput, Capacity> inputs;
+    uint32_t nextSequence, acknowledged;
+
+    PlayerState state;
+    std::array<glm::vec2, MaxCells> error;
+public:
+    Prediction();
+
+    void reset(const PlayerState &state);
+
+    // Applies a new input right away and returns it, stamped with its sequence number, to be sent.
+    // Beyond Capacity unacknowledged inputs the oldest ones can no longer be replayed.
+    MoveInput record(const glm::vec2 &pointer, float delta);
+
+    // Rewinds to the server state as of the acknowledged input and replays the newer ones.
+    void reconcile(const PlayerState &authoritative, uint32_t acknowledged);
+
+    // Fades the correction offset out over a few frames.
+    void update(float delta);
+
+    void setPoints(size_t cell, float points);
+
+    const PlayerState &getState() const;
+    // Predicted position with the remaining correction, what should be drawn.
+    glm::vec2 getDisplayPosition(size_t cell) const;
+
+    size_t getPendingCount() const;
+};
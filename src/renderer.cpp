@@ -0,0 +1,548 @@
+#include "renderer.h"
+
+#include <cstdio>
+
+static const uint8_t QuadCorners[] = {0,0, 1,0, 1,1, 0,1};
+static const int8_t FullscreenTriangle[] = {-1,-1, 3,-1, -1,3};
+
+// Share of the frame time the world passes may take on the GPU, the rest is left to the overlay and upscale.
+static const float SceneBudget = 0.75f;
+// The scale only grows again below this share of the budget, so it does not oscillate around it.
+static const float SceneHeadroom = 0.8f;
+
+WorldRenderer::WorldRenderer()
+    // Packet instances are uploaded as they are, the per-instance layouts mirror CellFloats and OverlayFloats.
+    : cells({
+        {BS::VertexLayout().add(0, 2, BS::AttributeType::UNSIGNED_BYTE), QuadCorners, sizeof(QuadCorners)},
+        // Center + half extents, hue, texture region and skin layer.
+        {BS::VertexLayout(1, GL_STREAM_DRAW).add(1, 4).add(2, 4).add(3, 4).add(4, 1)}
+    }, GL_TRIANGLE_FAN),
+    // Single triangle covering the whole screen, the grid is computed per pixel from the camera.
+    fullscreen({
+        {BS::VertexLayout().add(0, 2, BS::AttributeType::BYTE), FullscreenTriangle, sizeof(FullscreenTriangle)}
+    }, GL_TRIANGLES),
+    overlay({
+        {BS::VertexLayout().add(0, 2, BS::AttributeType::UNSIGNED_BYTE), QuadCorners, sizeof(QuadCorners)},
+        // Pixel rect, color and glyph region.
+        {BS::VertexLayout(1, GL_STREAM_DRAW).add(1, 4).add(2, 4).add(3, 4)}
+    }, GL_TRIANGLE_FAN),
+    worldShader("./assets/shaders/world.vert", "./assets/shaders/world.frag", nullptr),
+    gridShader("./assets/shaders/grid.vert", "./assets/shaders/grid.frag", nullptr),
+    overlayShader("./assets/shaders/overlay.vert", "./assets/shaders/overlay.frag", nullptr),
+    upscaleShader("./assets/shaders/upscale.vert", "./assets/shaders/upscale.frag", nullptr),
+    minimapShader("./assets/shaders/overlay.vert", "./assets/shaders/minimap.frag", nullptr),
+    particleShader("./assets/shaders/particles.vert", "./assets/shaders/particles.frag", nullptr),
+    skins(512, 512, 64),
+    font("./assets/fonts/DejaVuSans-Bold.ttf"),
+    particles(1 << 16, "./assets/shaders/particles_simulate.vert", "./assets/shaders/particles_simulate.geom"),
+    // Only ever sampled at its base level, allocated at the window size and reused below it.
+    scene({BS::Attachment(BS::AttachmentType::COLOR_RGB, BS::Texture::FILTER_LINEAR, BS::Texture::CLAMP_TO_EDGE, false)},
+          BS::Window::getFrameBufferWidth(), BS::Window::getFrameBufferHeight()) {
+    // Cells are drawn procedurally until their skin has been decoded and uploaded.
+    defaultSkin = textures.loadLayer("./assets/textures/Ball.png", skins);
+
+    // Empty until the server sends the first full grid.
+    std::vector<uint8_t> empty(DensityGrid::Size * DensityGrid::Size, 0);
+
+    glGenTextures(1, &minimap);
+    BS::GLStateCache::bindTexture(GL_TEXTURE_2D, minimap);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, DensityGrid::Size, DensityGrid::Size);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, DensityGrid::Size, DensityGrid::Size, GL_RED, GL_UNSIGNED_BYTE, empty.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // Particle sprites are sized in the vertex shader.
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    BS::GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void WorldRenderer::render(const BS::FramePacket &packet) {
+    BS_PROFILE_SCOPE("Render");
+
+    textures.update();
+    updateResolutionScale();
+
+    glm::ivec2 size = packet.view.framebufferSize;
+    glm::ivec2 scaled = glm::max(glm::ivec2(glm::vec2(size) * resolutionScale + 0.5f), glm::ivec2(1));
+
+    scene.resize(scaled.x, scaled.y);
+    scene.use();
+
+    sceneTimer.begin();
+    for(const BS::DrawCommand &command : packet.commands) {
+        switch(command.pass) {
+        case PASS_GRID: {
+            BS_PROFILE_SCOPE("Grid");
+            BS_PROFILE_GPU_SCOPE("Grid");
+            renderGrid(packet.view);
+            break;
+        }
+        case PASS_CELLS: {
+            BS_PROFILE_SCOPE("Cells");
+            BS_PROFILE_GPU_SCOPE("Cells");
+            renderCells(packet, command);
+            break;
+        }
+        case PASS_PARTICLES: {
+            BS_PROFILE_SCOPE("Particles");
+            BS_PROFILE_GPU_SCOPE("Particles");
+            renderParticles(packet, command);
+            break;
+        }
+        }
+    }
+    sceneTimer.end();
+
+    BS::GLStateCache::bindFramebuffer(output);
+    BS::Window::updateViewport(size.x, size.y);
+    BS::Window::clear();
+
+    {
+        BS_PROFILE_SCOPE("Upscale");
+        BS_PROFILE_GPU_SCOPE("Upscale");
+        renderUpscale();
+    }
+
+    for(const BS::DrawCommand &command : packet.commands) {
+        switch(command.pass) {
+        case PASS_OVERLAY: {
+            BS_PROFILE_SCOPE("Overlay");
+            BS_PROFILE_GPU_SCOPE("Overlay");
+            renderOverlay(packet, command);
+            break;
+        }
+        case PASS_MINIMAP_ROWS: {
+            BS_PROFILE_SCOPE("Minimap Upload");
+            renderMinimapRows(packet, command);
+            break;
+        }
+        case PASS_MINIMAP: {
+            BS_PROFILE_SCOPE("Minimap");
+            BS_PROFILE_GPU_SCOPE("Minimap");
+            renderMinimap(packet, command);
+            break;
+        }
+        }
+    }
+
+    {
+        BS_PROFILE_SCOPE("Swap");
+        BS::Window::swapBuffers();
+    }
+
+    // Timer queries from earlier frames, never waits on the GPU.
+    BS_PROFILE_GPU_COLLECT();
+
+    time.update();
+
+#ifdef BRAINSTORM_PROFILE
+    // State cache and resolution report once a second, in profiling builds only.
+    reportTimer += time.getRealDelta();
+
+    if(reportTimer >= 1) {
+        const BS::GLStateStats &stats = BS::GLStateCache::getStats();
+        BS::Logger::info("%llu GL state changes, %llu redundant skipped, world at %d%% resolution",
+                         static_cast<unsigned long long>(stats.getIssued()), static_cast<unsigned long long>(stats.getSkipped()),
+                         static_cast<int>(resolutionScale * 100.0f + 0.5f));
+
+        BS::GLStateCache::resetStats();
+        reportTimer = 0;
+    }
+#endif
+}
+
+void WorldRenderer::renderGrid(const BS::FrameView &view) {
+    BS::GLStateCache::setBlend(false);
+
+    gridShader.use();
+    gridShader.setFloat("gridSize", 1.0f);
+    gridShader.setFloat("lineWidth", 0.024f);
+    gridShader.setFloat("worldSize", 1000.0f);
+    gridShader.setFloat("aspect", view.aspect);
+    gridShader.setFloat("zoom", view.zoom);
+    gridShader.setVector2("cameraPosition", view.cameraPosition);
+
+    fullscreen.render();
+}
+
+void WorldRenderer::renderCells(const BS::FramePacket &packet, const BS::DrawCommand &command) {
+    BS::GLStateCache::setBlend(true);
+
+    if(command.count == 0) return;
+
+    cells.update(1, &packet.instances[command.offset], command.count * CellFloats * sizeof(float));
+
+    worldShader.use();
+    worldShader.setInt("skins", 0);
+    worldShader.setInt("glyphs", 1);
+    worldShader.setFloat("borderWidth", 0.08f);
+    // Outline of 0.05em, in distance field units.
+    worldShader.setFloat("outlineWidth", glm::min(0.05f / font.getDistanceRange(), 0.45f));
+    worldShader.setFloat("aspect", packet.view.aspect);
+    worldShader.setFloat("zoom", packet.view.zoom);
+    worldShader.setVector2("cameraPosition", packet.view.cameraPosition);
+
+    skins.use(0);
+    font.use(1);
+    cells.render(static_cast<GLsizei>(command.count));
+}
+
+void WorldRenderer::renderParticles(const BS::FramePacket &packet, const BS::DrawCommand &command) {
+    for(uint32_t i = 0; i < command.count; i++) {
+        const float *burst = &packet.instances[command.offset + i * BurstFloats];
+
+        particles.emit({
+            glm::vec2(burst[0], burst[1]), glm::vec2(burst[2], burst[3]),
+            glm::vec4(burst[4], burst[5], burst[6], burst[7]),
+            burst[8], burst[9], burst[10], static_cast<uint32_t>(burst[11])
+        });
+    }
+
+    // The render timer is updated at the end of a frame, this is the duration of the previous one.
+    particles.update(glm::min(time.getRealDelta(), 0.1f), 3.0f);
+
+    BS::GLStateCache::setBlend(true);
+
+    particleShader.use();
+    particleShader.setFloat("aspect", packet.view.aspect);
+    particleShader.setFloat("zoom", packet.view.zoom);
+    particleShader.setVector2("cameraPosition", packet.view.cameraPosition);
+    particleShader.setFloat("viewportHeight", static_cast<float>(scene.getHeight()));
+
+    particles.render();
+}
+
+void WorldRenderer::renderOverlay(const BS::FramePacket &packet, const BS::DrawCommand &command) {
+    BS::GLStateCache::setBlend(true);
+
+    if(command.count == 0) return;
+
+    overlay.update(1, &packet.instances[command.offset], command.count * OverlayFloats * sizeof(float));
+
+    overlayShader.use();
+    overlayShader.setInt("glyphs", 0);
+    overlayShader.setVector2("screenSize", glm::vec2(packet.view.framebufferSize));
+
+    font.use(0);
+
+    overlay.render(static_cast<GLsizei>(command.count));
+}
+
+void WorldRenderer::renderUpscale() {
+    BS::GLStateCache::setBlend(false);
+
+    upscaleShader.use();
+    upscaleShader.setInt("scene", 0);
+    upscaleShader.setVector2("regionScale", scene.getRegionScale());
+    upscaleShader.setVector2("texelSize", 1.0f / glm::vec2(scene.getCapacity()));
+    // No sharpening at native resolution, the most at the lowest scale.
+    upscaleShader.setFloat("sharpness", (1.0f - resolutionScale) * 0.5f);
+
+    BS::GLStateCache::bindTexture(GL_TEXTURE_2D, scene.getTexture(0), 0);
+    fullscreen.render();
+}
+
+void WorldRenderer::renderMinimapRows(const BS::FramePacket &packet, const BS::DrawCommand &command) {
+    const int Size = DensityGrid::Size;
+
+    if(command.count == 0) return;
+
+    std::array<uint8_t, Size * Size> rows;
+
+    BS::GLStateCache::bindTexture(GL_TEXTURE_2D, minimap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Rows arrive in ascending order, consecutive ones go up in a single call.
+    uint32_t first = 0;
+    for(uint32_t i = 0; i < command.count; i++) {
+        const float *source = &packet.instances[command.offset + i * MinimapRowFloats];
+        int row = static_cast<int>(source[0]);
+
+        for(int x = 0; x < Size; x++) {
+            rows[row * Size + x] = static_cast<uint8_t>(source[1 + x]);
+        }
+
+        bool last = i + 1 == command.count || static_cast<int>(packet.instances[command.offset + (i + 1) * MinimapRowFloats]) != row + 1;
+        if(!last) continue;
+
+        int start = static_cast<int>(packet.instances[command.offset + first * MinimapRowFloats]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, start, Size, row - start + 1, GL_RED, GL_UNSIGNED_BYTE, &rows[start * Size]);
+
+        first = i + 1;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void WorldRenderer::renderMinimap(const BS::FramePacket &packet, const BS::DrawCommand &command) {
+    BS::GLStateCache::setBlend(true);
+
+    if(command.count == 0) return;
+
+    overlay.update(1, &packet.instances[command.offset], command.count * OverlayFloats * sizeof(float));
+
+    minimapShader.use();
+    minimapShader.setInt("density", 0);
+    minimapShader.setVector2("screenSize", glm::vec2(packet.view.framebufferSize));
+    minimapShader.setVector2("marker", packet.view.cameraPosition / DensityGrid::WorldSize * 0.5f + 0.5f);
+
+    BS::GLStateCache::bindTexture(GL_TEXTURE_2D, minimap, 0);
+
+    overlay.render(static_cast<GLsizei>(command.count));
+}
+
+void WorldRenderer::updateResolutionScale() {
+    // Only the newest result matters, older ones still queued after a stall are skipped.
+    bool updated = false;
+    while(sceneTimer.poll()) updated = true;
+
+    if(!updated) return;
+
+    float budget = targetFrameTime * SceneBudget;
+    float elapsed = glm::max(sceneTimer.getMilliseconds(), 0.01f);
+
+    // The world passes are fill bound, their cost follows the pixel count and so the square of the scale.
+    float ideal = resolutionScale * glm::sqrt(budget / elapsed);
+
+    // Drops at once when over budget, recovers a step per frame once there is clear headroom.
+    if(ideal < resolutionScale) {
+        resolutionScale = glm::max(ideal, resolutionScale - 0.1f);
+    } else if(elapsed < budget * SceneHeadroom) {
+        resolutionScale = glm::min(ideal, resolutionScale + 0.01f);
+    }
+
+    resolutionScale = glm::clamp(resolutionScale, minimumScale, maximumScale);
+}
+
+void WorldRenderer::destroy() {
+    cells.destroy();
+    fullscreen.destroy();
+    overlay.destroy();
+    worldShader.destroy();
+    gridShader.destroy();
+    overlayShader.destroy();
+    upscaleShader.destroy();
+    minimapShader.destroy();
+    particleShader.destroy();
+    particles.destroy();
+    scene.clear();
+    sceneTimer.destroy();
+    textures.destroy();
+    skins.destroy();
+    font.destroy();
+
+    BS::GLStateCache::forgetTexture(minimap);
+    glDeleteTextures(1, &minimap);
+    BS_PROFILE_GPU_DESTROY();
+}
+
+void WorldRenderer::setTargetFrameTime(float milliseconds) {
+    targetFrameTime = milliseconds;
+}
+
+void WorldRenderer::setResolutionScale(float minimum, float maximum) {
+    minimumScale = minimum;
+    maximumScale = maximum;
+    resolutionScale = glm::clamp(resolutionScale, minimum, maximum);
+}
+
+void WorldRenderer::setOutput(GLuint framebuffer) {
+    output = framebuffer;
+}
+
+GLint WorldRenderer::getDefaultSkin() const {
+    return textures.getLayer(defaultSkin);
+}
+
+BS::Font &WorldRenderer::getFont() {
+    return font;
+}
+
+uint16_t WorldRenderer::getDrawKey(double mass) {
+    // 1/1024 of a doubling per step, distinct down to masses about 0.07% apart.
+    double key = glm::log2(glm::max(mass, 0.0) + 1.0) * 1024.0;
+    return static_cast<uint16_t>(glm::min(key, 65535.0));
+}
+
+void WorldRenderer::pushCell(BS::FramePacket &packet, const glm::vec2 &position, float radius, const glm::vec4 &hue, GLint skin) {
+    packet.instances.insert(packet.instances.end(), {
+        position.x, position.y, radius, radius,
+        hue.x, hue.y, hue.z, hue.w,
+        0.0f, 0.0f, 1.0f, 1.0f,
+        static_cast<float>(skin)
+    });
+}
+
+void WorldRenderer::pushRect(BS::FramePacket &packet, const glm::vec4 &rect, const glm::vec4 &color) {
+    packet.instances.insert(packet.instances.end(), {
+        rect.x, rect.y, rect.z, rect.w,
+        color.x, color.y, color.z, color.w,
+        0.0f, 0.0f, 0.0f, 0.0f
+    });
+}
+
+void WorldRenderer::pushParticles(BS::FramePacket &packet, const std::vector<BS::ParticleBurst> &bursts) {
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+
+    for(const BS::ParticleBurst &burst : bursts) {
+        packet.instances.insert(packet.instances.end(), {
+            burst.position.x, burst.position.y, burst.velocity.x, burst.velocity.y,
+            burst.color.x, burst.color.y, burst.color.z, burst.color.w,
+            burst.speed, burst.lifetime, burst.size, static_cast<float>(burst.count)
+        });
+    }
+
+    packet.draw(PASS_PARTICLES, offset, static_cast<uint32_t>(bursts.size()));
+}
+
+void WorldRenderer::pushText(BS::FramePacket &packet, BS::Font &font, const std::string &text, const glm::vec2 &center, float size, const glm::vec4 &color) {
+    pushText(packet, font, font.shape(text), center, size, color);
+}
+
+void WorldRenderer::pushText(BS::FramePacket &packet, const BS::Font &font, const BS::ShapedText &shaped, const glm::vec2 &center, float size, const glm::vec4 &color) {
+    // Centered on the box between ascender and descender, world space is y up like the glyph metrics.
+    glm::vec2 origin = center - glm::vec2(shaped.width, font.getAscent() - font.getDescent()) * 0.5f * size;
+
+    for(const BS::TextQuad &quad : shaped.quads) {
+        glm::vec2 extents = quad.size * size * 0.5f;
+        glm::vec2 position = origin + quad.position * size + extents;
+
+        // The atlas has its rows top down, flip the region so the bottom of the quad samples the bottom of the glyph.
+        packet.instances.insert(packet.instances.end(), {
+            position.x, position.y, extents.x, extents.y,
+            color.x, color.y, color.z, color.w,
+            quad.uv.x, quad.uv.w, quad.uv.z, quad.uv.y,
+            static_cast<float>(GlyphLayer)
+        });
+    }
+}
+
+uint32_t WorldRenderer::pushOverlayText(BS::FramePacket &packet, BS::Font &font, std::string_view text, const glm::vec2 &position, float size, const glm::vec4 &color) {
+    const BS::ShapedText &shaped = font.shape(text);
+    float baseline = position.y + font.getAscent() * size;
+
+    // Overlay space is y down, the glyph offsets are y up from the baseline.
+    for(const BS::TextQuad &quad : shaped.quads) {
+        packet.instances.insert(packet.instances.end(), {
+            position.x + quad.position.x * size, baseline - (quad.position.y + quad.size.y) * size, quad.size.x * size, quad.size.y * size,
+            color.x, color.y, color.z, color.w,
+            quad.uv.x, quad.uv.y, quad.uv.z, quad.uv.w
+        });
+    }
+
+    return static_cast<uint32_t>(shaped.quads.size());
+}
+
+void WorldRenderer::pushLeaderboard(BS::FramePacket &packet, BS::Font &font, const std::vector<std::string> &entries) {
+    const float Width = 260.0f, Margin = 10.0f, Padding = 12.0f, TitleSize = 28.0f, LineSize = 20.0f;
+
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+    uint32_t count = 1;
+
+    float height = Padding * 2.0f + TitleSize * 1.2f + LineSize * 1.2f * entries.size();
+    glm::vec2 position(packet.view.framebufferSize.x - Width - Margin, Margin);
+
+    pushRect(packet, glm::vec4(position, Width, height), glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
+
+    const BS::ShapedText &title = font.shape("Leaderboard");
+    count += pushOverlayText(packet, font, "Leaderboard", glm::vec2(position.x + (Width - title.width * TitleSize) * 0.5f, position.y + Padding), TitleSize, glm::vec4(1.0f));
+
+    float y = position.y + Padding + TitleSize * 1.2f;
+    for(const std::string &entry : entries) {
+        count += pushOverlayText(packet, font, entry, glm::vec2(position.x + Padding, y), LineSize, glm::vec4(1.0f));
+        y += LineSize * 1.2f;
+    }
+
+    packet.draw(PASS_OVERLAY, offset, count);
+}
+
+void WorldRenderer::pushTextPanel(BS::FramePacket &packet, BS::Font &font, const std::vector<std::string> &lines, const glm::vec2 &position, float lineSize) {
+    const float Padding = 8.0f;
+
+    float width = 0.0f;
+    for(const std::string &line : lines) {
+        width = glm::max(width, font.shape(line).width * lineSize);
+    }
+
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+    uint32_t count = 1;
+
+    pushRect(packet, glm::vec4(position, width + Padding * 2.0f, lineSize * 1.2f * lines.size() + Padding * 2.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+
+    float y = position.y + Padding;
+    for(const std::string &line : lines) {
+        count += pushOverlayText(packet, font, line, glm::vec2(position.x + Padding, y), lineSize, glm::vec4(1.0f));
+        y += lineSize * 1.2f;
+    }
+
+    packet.draw(PASS_OVERLAY, offset, count);
+}
+
+void WorldRenderer::pushMinimapRows(BS::FramePacket &packet, const uint8_t *cells, uint64_t rows) {
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+    uint32_t count = 0;
+
+    for(int row = 0; row < DensityGrid::Size; row++) {
+        if(!(rows & (uint64_t(1) << row))) continue;
+
+        packet.instances.push_back(static_cast<float>(row));
+
+        const uint8_t *values = cells + row * DensityGrid::Size;
+        packet.instances.insert(packet.instances.end(), values, values + DensityGrid::Size);
+
+        count++;
+    }
+
+    packet.draw(PASS_MINIMAP_ROWS, offset, count);
+}
+
+void WorldRenderer::pushMinimap(BS::FramePacket &packet, const glm::vec2 &position, float size) {
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+
+    // Row 0 of the grid is the bottom of the world, overlay space is y down.
+    packet.instances.insert(packet.instances.end(), {
+        position.x, position.y, size, size,
+        1.0f, 1.0f, 1.0f, 0.85f,
+        0.0f, 1.0f, 1.0f, 0.0f
+    });
+
+    packet.draw(PASS_MINIMAP, offset, 1);
+}
+
+void WorldRenderer::pushFrameGraph(BS::FramePacket &packet, BS::Font &font, const BS::FramePacer &pacer, const glm::vec2 &position) {
+    const float BarWidth = 2.0f, PixelsPerMillisecond = 4.0f, Height = 100.0f, LineSize = 14.0f;
+
+    uint32_t offset = static_cast<uint32_t>(packet.instances.size());
+    size_t frames = pacer.getFrameCount();
+
+    pushRect(packet, glm::vec4(position, BarWidth * BS::FramePacer::HistorySize, Height), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+
+    for(size_t i = 0; i < frames; i++) {
+        float frameTime = pacer.getFrameTime(i);
+        float height = glm::min(frameTime * PixelsPerMillisecond, Height);
+
+        glm::vec4 color = frameTime > pacer.getTargetFrameTime() + 0.5f ? glm::vec4(0.9f, 0.3f, 0.2f, 0.9f) : glm::vec4(0.3f, 0.8f, 0.3f, 0.9f);
+        pushRect(packet, glm::vec4(position.x + i * BarWidth, position.y + Height - height, BarWidth, height), color);
+    }
+
+    // Target frame time and the current p99.
+    BS::FrameStats stats = pacer.getStats();
+    float width = BarWidth * BS::FramePacer::HistorySize;
+
+    pushRect(packet, glm::vec4(position.x, position.y + Height - glm::min(pacer.getTargetFrameTime() * PixelsPerMillisecond, Height), width, 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.8f));
+    pushRect(packet, glm::vec4(position.x, position.y + Height - glm::min(stats.p99 * PixelsPerMillisecond, Height), width, 1.0f), glm::vec4(1.0f, 0.9f, 0.2f, 0.8f));
+
+    char line[128];
+    snprintf(line, sizeof(line), "frame avg %.2f  p50 %.2f  p99 %.2f  max %.2f ms  jitter %+.2f ms", stats.average, stats.p50, stats.p99, stats.max, stats.jitter);
+    uint32_t count = pushOverlayText(packet, font, line, glm::vec2(position.x, position.y + Height + 4.0f), LineSize, glm::vec4(1.0f));
+
+    packet.draw(PASS_OVERLAY, offset, static_cast<uint32_t>(frames + 3) + count);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "engine/engine.h"
+#include "../common/densitygrid.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum RenderPass : uint16_t {
+    PASS_GRID,
+    PASS_CELLS,
+    PASS_PARTICLES,
+    PASS_OVERLAY,
+    PASS_MINIMAP_ROWS,
+    PASS_MINIMAP
+};
+
+// Backend half of the client: owns every GL resource of the world and draws the frame packets
+// recorded by the game thread. Everything except the constructor runs on the render thread.
+class WorldRenderer {
+private:
+    BS::Mesh cells, fullscreen, overlay;
+    BS::ShaderProgram worldShader, gridShader, overlayShader, upscaleShader, minimapShader, particleShader;
+    BS::TextureArray skins;
+    BS::Font font;
+    BS::TextureLoader textures;
+    BS::ParticleSystem particles;
+
+    BS::TextureHandle defaultSkin;
+
+    // DensityGrid::Size squared, one byte per cell. Only the rows the server changed are uploaded.
+    GLuint minimap;
+
+    // World passes are drawn into a scaled offscreen target and upscaled, the overlay stays at native resolution.
+    // The scale follows the GPU time of the world passes, measured a few frames behind.
+    BS::FrameBuffer scene;
+    BS::GpuTimer sceneTimer;
+
+    float resolutionScale = 1.0f, minimumScale = 0.5f, maximumScale = 1.0f;
+    float targetFrameTime = 1000.0f / 60.0f;
+
+    GLuint output = 0;
+
+    BS::Timer time;
+    float reportTimer = 0.0f;
+
+    void renderGrid(const BS::FrameView &view);
+    void renderCells(const BS::FramePacket &packet, const BS::DrawCommand &command);
+    void renderParticles(const BS::FramePacket &packet, const BS::DrawCommand &command);
+    void renderOverlay(const BS::FramePacket &packet, const BS::DrawCommand &command);
+    void renderUpscale();
+    void renderMinimapRows(const BS::FramePacket &packet, const BS::DrawCommand &command);
+    void renderMinimap(const BS::FramePacket &packet, const BS::DrawCommand &command);
+
+    void updateResolutionScale();
+public:
+    // Interleaved cell instance: center.xy, half extents.xy, hue.rgba, texture region.xyzw, skin layer.
+    // Label glyphs are instances of the same stream, so a label is drawn right after its cell.
+    static const uint32_t CellFloats = 13;
+    // Interleaved overlay instance: rect.xywh in pixels from the top left corner, color.rgba, glyph region.xyzw.
+    static const uint32_t OverlayFloats = 12;
+    // Minimap row update: row index, then DensityGrid::Size cell values.
+    static const uint32_t MinimapRowFloats = 1 + DensityGrid::Size;
+    // Particle burst, laid out like the emitter points of BS::ParticleSystem.
+    static const uint32_t BurstFloats = BS::ParticleSystem::ParticleFloats;
+
+    // Layer of glyph instances in the cell stream, -1 is a procedural circle.
+    static const GLint GlyphLayer = -2;
+
+    WorldRenderer();
+
+    void render(const BS::FramePacket &packet);
+    void destroy();
+
+    // Frame time the resolution scale tries to hold, in milliseconds. Set before the render thread starts.
+    void setTargetFrameTime(float milliseconds);
+    // Bounds of the world resolution scale, the same value twice pins it.
+    void setResolutionScale(float minimum, float maximum);
+    // Framebuffer the finished frame is drawn into, 0 for the window.
+    void setOutput(GLuint framebuffer);
+
+    // Skin layer, -1 until the loader has streamed it in. Safe to call from the game thread.
+    GLint getDefaultSkin() const;
+
+    // Shaping happens on the game thread while recording, the render thread only binds the atlas.
+    BS::Font &getFont();
+
+    // Sort key for the cell draw order, mass quantized on a log scale so it fits 16 bits.
+    static uint16_t getDrawKey(double mass);
+
+    static void pushCell(BS::FramePacket &packet, const glm::vec2 &position, float radius, const glm::vec4 &hue, GLint skin);
+    static void pushRect(BS::FramePacket &packet, const glm::vec4 &rect, const glm::vec4 &color);
+
+    // Bursts spawned this frame. Recorded every frame, even without bursts, as it also advances the live particles.
+    static void pushParticles(BS::FramePacket &packet, const std::vector<BS::ParticleBurst> &bursts);
+
+    // Label centered on a point in world space, size is the em height in world units.
+    static void pushText(BS::FramePacket &packet, BS::Font &font, const std::string &text, const glm::vec2 &center, float size, const glm::vec4 &color);
+    // Text shaped ahead, for labels that are kept between frames.
+    static void pushText(BS::FramePacket &packet, const BS::Font &font, const BS::ShapedText &shaped, const glm::vec2 &center, float size, const glm::vec4 &color);
+    // Overlay text from its top left corner, size in pixels. Returns the number of instances pushed.
+    static uint32_t pushOverlayText(BS::FramePacket &packet, BS::Font &font, std::string_view text, const glm::vec2 &position, float size, const glm::vec4 &color);
+
+    // Leaderboard panel in the top right corner, one line per entry in a single overlay draw.
+    static void pushLeaderboard(BS::FramePacket &packet, BS::Font &font, const std::vector<std::string> &entries);
+    // Panel sized to its lines from its top left corner, line size in pixels.
+    static void pushTextPanel(BS::FramePacket &packet, BS::Font &font, const std::vector<std::string> &lines, const glm::vec2 &position, float lineSize);
+
+    // Rows set in the mask out of DensityGrid::Size rows of cells, uploaded before the minimap is drawn.
+    static void pushMinimapRows(BS::FramePacket &packet, const uint8_t *cells, uint64_t rows);
+    // Minimap as a single overlay quad, position of its top left corner and size in pixels.
+    static void pushMinimap(BS::FramePacket &packet, const glm::vec2 &position, float size);
+
+    // Frame time graph of the pacer history as overlay rects, with its statistics on a line below.
+    static void pushFrameGraph(BS::FramePacket &packet, BS::Font &font, const BS::FramePacer &pacer, const glm::vec2 &position);
+};
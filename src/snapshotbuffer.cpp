@@ -0,0 +1,134 @@
+#include "snapshotbuffer.h"
+
+#include <algorithm>
+
+SnapshotBuffer::SnapshotBuffer()
+    : head(0), tickInterval(1.0 / 32.0), offset(0.0), jitter(0.0), delay(1.0 / 16.0), lastReceive(0.0), lastServerTime(0.0) {}
+
+void SnapshotBuffer::setTickRate(uint16_t tickRate) {
+    tickInterval = 1.0 / glm::max<double>(tickRate, 1.0);
+    delay = tickInterval * 2.0;
+}
+
+bool SnapshotBuffer::push(uint32_t tick, const EntityState *entities, size_t count, double receiveTime) {
+    // The channel is sequenced, this only guards against anything older slipping through.
+    if(head > 0 && tick <= snapshots[(head - 1) % Capacity].tick) return false;
+
+    Snapshot &snapshot = snapshots[head % Capacity];
+    snapshot.tick = tick;
+    snapshot.entities.assign(entities, entities + glm::min(count, MaxEntities));
+
+    snapshot.serverTime = snapshot.tick * tickInterval;
+    double transit = receiveTime - snapshot.serverTime;
+
+    if(head == 0) {
+        offset = transit;
+    } else {
+        double deviation = (receiveTime - lastReceive) - (snapshot.serverTime - lastServerTime);
+        jitter += (glm::abs(deviation) - jitter) / 16.0;
+
+        // Snaps down to faster transits, creeps up so clock drift and route changes are followed.
+        offset = glm::min(transit, offset + (transit - offset) * 0.01);
+    }
+
+    lastReceive = receiveTime;
+    lastServerTime = snapshot.serverTime;
+
+    // One tick to always have a snapshot ahead, plus room for late ones. Eased in so the render time never jumps.
+    double target = glm::clamp(tickInterval * 1.5 + jitter * 3.0, tickInterval, 0.3);
+    delay += (target - delay) * 0.1;
+
+    head++;
+    return true;
+}
+
+void SnapshotBuffer::reset() {
+    head = 0;
+    jitter = 0.0;
+}
+
+double SnapshotBuffer::getRenderTime(double now) const {
+    return now - offset - delay;
+}
+
+size_t SnapshotBuffer::sample(double now) {
+    if(head == 0) return 0;
+
+    double time = getRenderTime(now);
+    uint64_t available = glm::min<uint64_t>(head, Capacity);
+
+    // Newest snapshot at or before the render time, the oldest one if all of them are ahead.
+    uint64_t older = head - available;
+    for(uint64_t i = head; i > head - available; i--) {
+        if(snapshots[(i - 1) % Capacity].serverTime <= time) {
+            older = i - 1;
+            break;
+        }
+    }
+
+    const Snapshot &from = snapshots[older % Capacity];
+    // Past the newest snapshot the entities hold still rather than guessing.
+    const Snapshot &to = older + 1 < head ? snapshots[(older + 1) % Capacity] : from;
+
+    double span = to.serverTime - from.serverTime;
+    float alpha = span > 0.0 ? static_cast<float>(glm::clamp((time - from.serverTime) / span, 0.0, 1.0)) : 1.0f;
+
+    lookup.fill(-1);
+    for(size_t i = 0; i < from.entities.size(); i++) {
+        lookup[from.entities[i].id] = static_cast<int16_t>(i);
+    }
+
+    // Entities that left are gone with the newer snapshot, new ones appear at their first position.
+    interpolated.resize(to.entities.size());
+    for(size_t i = 0; i < to.entities.size(); i++) {
+        const EntityState &target = to.entities[i];
+        interpolated[i] = target;
+
+        if(lookup[target.id] < 0) continue;
+
+        const EntityState &source = from.entities[lookup[target.id]];
+        interpolated[i].position = glm::mix(source.position, target.position, alpha);
+        interpolated[i].points = glm::mix(source.points, target.points, alpha);
+    }
+
+    return to.entities.size();
+}
+
+const EntityState *SnapshotBuffer::getEntities() const {
+    return interpolated.data();
+}
+
+bool SnapshotBuffer::getLatest(uint8_t id, EntityState &entity, uint32_t &tick) const {
+    if(head == 0) return false;
+
+    const Snapshot &snapshot = snapshots[(head - 1) % Capacity];
+    for(const EntityState &candidate : snapshot.entities) {
+        if(candidate.id != id) continue;
+
+        entity = candidate;
+        tick = snapshot.tick;
+        return true;
+    }
+
+    return false;
+}
+
+double SnapshotBuffer::getDelay() const {
+    return delay;
+}
+
+double SnapshotBuffer::getJitter() const {
+    return jitter;
+}
+
+size_t SnapshotBuffer::getDepth(double now) const {
+    double time = getRenderTime(now);
+    size_t depth = 0;
+
+    for(uint64_t i = head; i > head - glm::min<uint64_t>(head, Capacity); i--) {
+        if(snapshots[(i - 1) % Capacity].serverTime <= time) break;
+        depth++;
+    }
+
+    return depth;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "../common/protocol.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Time stamped ring of the latest server snapshots. Remote entities are drawn interpolated between the two
+// snapshots around now - delay, where the delay follows the measured arrival jitter. Snapshots keep their storage,
+// it grows with the number of entities and only allocates when a snapshot is bigger than any before in its slot.
+class SnapshotBuffer {
+public:
+    static const size_t Capacity = 32;
+    static const size_t MaxEntities = 256;
+
+    struct Snapshot {
+        uint32_t tick;
+        double serverTime; // tick / tick rate, in seconds
+        std::vector<EntityState> entities;
+    };
+private:
+    std::array<Snapshot, Capacity> snapshots;
+    uint64_t head; // Snapshots received so far, the newest one is at head - 1
+
+    double tickInterval;
+    double offset; // Local receive time minus server time of the fastest recent snapshot
+    double jitter; // Mean deviation of the arrival spacing, as in RFC 3550
+    double delay;
+
+    double lastReceive, lastServerTime;
+
+    std::array<int16_t, 256> lookup; // Entity id to index in the older snapshot, scratch for sample()
+    std::vector<EntityState> interpolated;
+
+    double getRenderTime(double now) const;
+public:
+    SnapshotBuffer();
+
+    void setTickRate(uint16_t tickRate);
+    // Forgets every snapshot, the ticks of a new connection start over.
+    void reset();
+
+    // Copies a decoded snapshot into the ring. Snapshots older than the newest one are dropped.
+    bool push(uint32_t tick, const EntityState *entities, size_t count, double receiveTime);
+
+    // Remote entities at now - delay, readable through getEntities(). Returns their count.
+    size_t sample(double now);
+    const EntityState *getEntities() const;
+
+    // Entity as of the newest snapshot, not interpolated. What the local player reconciles against.
+    bool getLatest(uint8_t id, EntityState &entity, uint32_t &tick) const;
+
+    double getDelay() const;
+    double getJitter() const;
+    // Snapshots received but not yet reached by the render time.
+    size_t getDepth(double now) const;
+};
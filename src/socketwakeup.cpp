@@ -0,0 +1,86 @@
+#include "socketwakeup.h"
+
+#include <iostream>
+
+SocketWakeup::SocketWakeup() : socket(ENET_SOCKET_NULL), address(), armed(false) {}
+
+SocketWakeup::~SocketWakeup() {
+    destroy();
+}
+
+bool SocketWakeup::create() {
+    socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if(socket == ENET_SOCKET_NULL) {
+        std::cout << "Could not create the wakeup socket\n";
+        return false;
+    }
+
+    // Any free port on loopback, then read back which one it got.
+    enet_address_set_host_ip(&address, "127.0.0.1");
+    address.port = 0;
+
+    if(enet_socket_bind(socket, &address) < 0 || enet_socket_get_address(socket, &address) < 0) {
+        std::cout << "Could not bind the wakeup socket\n";
+        destroy();
+        return false;
+    }
+
+    enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+    return true;
+}
+
+void SocketWakeup::destroy() {
+    if(socket == ENET_SOCKET_NULL) return;
+
+    enet_socket_destroy(socket);
+    socket = ENET_SOCKET_NULL;
+}
+
+void SocketWakeup::arm() {
+    armed.store(true);
+    // Orders the flag before whatever the caller checks next, against the fence in signal().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void SocketWakeup::wait(ENetSocket host, uint32_t timeout) {
+    if(socket == ENET_SOCKET_NULL) {
+        uint32_t condition = ENET_SOCKET_WAIT_RECEIVE;
+        enet_socket_wait(host, &condition, timeout);
+
+        armed.store(false);
+        return;
+    }
+
+    ENetSocketSet readSet;
+    ENET_SOCKETSET_EMPTY(readSet);
+    ENET_SOCKETSET_ADD(readSet, host);
+    ENET_SOCKETSET_ADD(readSet, socket);
+
+    int ready = enet_socketset_select(host > socket ? host : socket, &readSet, nullptr, timeout);
+    armed.store(false);
+
+    if(ready <= 0 || !ENET_SOCKETSET_CHECK(readSet, socket)) return;
+
+    // Several signals may have piled up, one wakeup covers all of them.
+    uint8_t byte;
+    ENetAddress from;
+
+    ENetBuffer buffer;
+    buffer.data = &byte;
+    buffer.dataLength = 1;
+
+    while(enet_socket_receive(socket, &from, &buffer, 1) > 0) {}
+}
+
+void SocketWakeup::signal() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(!armed.exchange(false) || socket == ENET_SOCKET_NULL) return;
+
+    uint8_t byte = 0;
+
+    ENetBuffer buffer;
+    buffer.data = &byte;
+    buffer.dataLength = 1;
+
+    enet_socket_send(socket, &address, &buffer, 1);
+}
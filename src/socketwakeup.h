@@ -0,0 +1,29 @@
+#pragma once
+#include <enet/enet.h>
+
+#include <atomic>
+#include <cstdint>
+
+// Interrupts a thread waiting on an ENet socket, from any other thread. The signal is a datagram to a loopback
+// socket that is waited on next to the host socket, so it works wherever ENet does, unlike eventfd.
+class SocketWakeup {
+private:
+    ENetSocket socket;
+    ENetAddress address;
+
+    std::atomic<bool> armed;
+public:
+    SocketWakeup();
+    ~SocketWakeup();
+
+    bool create();
+    void destroy();
+
+    // Waiting thread. Conditions checked after arming cannot miss a signal, wait() picks it up.
+    void arm();
+    // Waiting thread. Blocks until the host socket is readable, a signal arrives or timeout milliseconds passed.
+    void wait(ENetSocket host, uint32_t timeout);
+
+    // Any thread. Only costs a datagram while the other side is armed.
+    void signal();
+};